@@ -0,0 +1,92 @@
+#include "attack_fill.hh"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(CHESSTER_AVX2_FILL_DISPATCH) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace engine {
+
+bool FILL_USE_AVX2 = AVX2_FILL_COMPILED;
+
+#if defined(CHESSTER_AVX2_FILL_DISPATCH) || defined(__AVX2__)
+// One Kogge-Stone step on four directions at once: lanes are N, E, NE, NW
+// when shifting up and S, W, SW, SE when shifting down, so both halves share
+// the shift counts and only the wrap masks differ.
+__attribute__((target("avx2"))) Bitboard slider_fill_avx2(Bitboard rq, Bitboard bq, Bitboard occ)
+{
+    const __m256i gen0 = _mm256_setr_epi64x(rq, rq, bq, bq);
+    const __m256i empty = _mm256_set1_epi64x(static_cast<long long>(~occ));
+    const __m256i s1 = _mm256_setr_epi64x(8, 1, 9, 7);
+    const __m256i s2 = _mm256_slli_epi64(s1, 1);
+    const __m256i s4 = _mm256_slli_epi64(s1, 2);
+
+    const long long all = -1;
+    const long long notA = static_cast<long long>(fill::NOT_A);
+    const long long notH = static_cast<long long>(fill::NOT_H);
+    const __m256i wrapUp = _mm256_setr_epi64x(all, notA, notA, notH);
+    const __m256i wrapDown = _mm256_setr_epi64x(all, notH, notH, notA);
+
+    __m256i gen = gen0;
+    __m256i pro = _mm256_and_si256(empty, wrapUp);
+    gen = _mm256_or_si256(gen, _mm256_and_si256(pro, _mm256_sllv_epi64(gen, s1)));
+    pro = _mm256_and_si256(pro, _mm256_sllv_epi64(pro, s1));
+    gen = _mm256_or_si256(gen, _mm256_and_si256(pro, _mm256_sllv_epi64(gen, s2)));
+    pro = _mm256_and_si256(pro, _mm256_sllv_epi64(pro, s2));
+    gen = _mm256_or_si256(gen, _mm256_and_si256(pro, _mm256_sllv_epi64(gen, s4)));
+    const __m256i up = _mm256_and_si256(_mm256_sllv_epi64(gen, s1), wrapUp);
+
+    gen = gen0;
+    pro = _mm256_and_si256(empty, wrapDown);
+    gen = _mm256_or_si256(gen, _mm256_and_si256(pro, _mm256_srlv_epi64(gen, s1)));
+    pro = _mm256_and_si256(pro, _mm256_srlv_epi64(pro, s1));
+    gen = _mm256_or_si256(gen, _mm256_and_si256(pro, _mm256_srlv_epi64(gen, s2)));
+    pro = _mm256_and_si256(pro, _mm256_srlv_epi64(pro, s2));
+    gen = _mm256_or_si256(gen, _mm256_and_si256(pro, _mm256_srlv_epi64(gen, s4)));
+    const __m256i down = _mm256_and_si256(_mm256_srlv_epi64(gen, s1), wrapDown);
+
+    const __m256i any = _mm256_or_si256(up, down);
+    const __m128i half = _mm_or_si128(_mm256_castsi256_si128(any), _mm256_extracti128_si256(any, 1));
+    return static_cast<Bitboard>(_mm_cvtsi128_si64(_mm_or_si128(half, _mm_unpackhi_epi64(half, half))));
+}
+#else
+Bitboard slider_fill_avx2(Bitboard rq, Bitboard bq, Bitboard occ)
+{
+    return slider_fill_scalar(rq, bq, occ);
+}
+#endif
+
+// CHESSTER_FILL=magic turns the fill off on AVX2 hosts.
+static bool pick_avx2()
+{
+    if (AVX2_FILL_COMPILED)
+        return true;
+#if defined(CHESSTER_AVX2_FILL_DISPATCH)
+    if (!__builtin_cpu_supports("avx2"))
+        return false;
+    if (const char* env = std::getenv("CHESSTER_FILL"))
+        return std::strcmp(env, "magic") != 0;
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char* fill_backend()
+{
+    return fill_avx2() ? "avx2" : "none";
+}
+
+namespace {
+struct FillInit {
+    FillInit()
+    {
+        FILL_USE_AVX2 = pick_avx2();
+    }
+};
+const FillInit g_fill_init;
+} // namespace
+
+} // namespace engine
@@ -0,0 +1,85 @@
+#pragma once
+#include "bitboard.hh"
+
+namespace engine {
+
+// Set-wise slider attacks (Kogge-Stone occluded fill).
+// Every rook/queen and bishop/queen of one side is flooded along its rays at
+// once, in three doubling steps per direction, so the cost does not depend on
+// the number of sliders and no table is touched.
+//
+// The fill only pays off with four directions per AVX2 register; one direction
+// at a time it is slower than per-piece magic lookups. Availability, picked
+// like the slider backends in magic.hh:
+//   AVX2 compiled in (-march=native on such a host): always.
+//   x86-64 otherwise: by CPUID at startup.
+//   elsewhere: never (slider_fill_scalar remains as the reference).
+#if defined(__AVX2__)
+inline constexpr bool AVX2_FILL_COMPILED = true;
+#elif (defined(__GNUG__) || defined(__clang__)) && defined(__x86_64__)
+#define CHESSTER_AVX2_FILL_DISPATCH 1
+inline constexpr bool AVX2_FILL_COMPILED = false;
+#else
+inline constexpr bool AVX2_FILL_COMPILED = false;
+#endif
+
+// true if slider_fill_avx2() may be called (set before any lookup)
+extern bool FILL_USE_AVX2;
+
+// "avx2" or "none", for diagnostics
+const char* fill_backend();
+
+namespace fill {
+
+// 'gen' flooded through 'empty' one step of S at a time (S > 0 shifts up);
+// 'wrap' drops squares that a step would reach by wrapping round the board
+template <int S> constexpr Bitboard shift(Bitboard b)
+{
+    if constexpr (S > 0)
+        return b << S;
+    else
+        return b >> -S;
+}
+
+template <int S> constexpr Bitboard ray_attacks(Bitboard gen, Bitboard empty, Bitboard wrap)
+{
+    Bitboard pro = empty & wrap;
+    gen |= pro & shift<S>(gen);
+    pro &= shift<S>(pro);
+    gen |= pro & shift<2 * S>(gen);
+    pro &= shift<2 * S>(pro);
+    gen |= pro & shift<4 * S>(gen);
+    return shift<S>(gen) & wrap;
+}
+
+inline constexpr Bitboard NOT_A = ~FileBB[0];
+inline constexpr Bitboard NOT_H = ~FileBB[7];
+
+} // namespace fill
+
+// Squares attacked by the orthogonal sliders 'rq' and diagonal sliders 'bq',
+// with rays stopped by (and including) the first piece of 'occ'; the eight
+// directions one after another.
+constexpr Bitboard slider_fill_scalar(Bitboard rq, Bitboard bq, Bitboard occ)
+{
+    using namespace fill;
+    const Bitboard empty = ~occ;
+    return ray_attacks<8>(rq, empty, ~0ULL) | ray_attacks<-8>(rq, empty, ~0ULL) | ray_attacks<1>(rq, empty, NOT_A) |
+           ray_attacks<-1>(rq, empty, NOT_H) | ray_attacks<9>(bq, empty, NOT_A) | ray_attacks<7>(bq, empty, NOT_H) |
+           ray_attacks<-7>(bq, empty, NOT_A) | ray_attacks<-9>(bq, empty, NOT_H);
+}
+
+// Same as slider_fill_scalar, four directions per instruction; only call
+// when fill_avx2() is true
+Bitboard slider_fill_avx2(Bitboard rq, Bitboard bq, Bitboard occ);
+
+inline bool fill_avx2()
+{
+#if defined(CHESSTER_AVX2_FILL_DISPATCH)
+    return FILL_USE_AVX2;
+#else
+    return AVX2_FILL_COMPILED;
+#endif
+}
+
+} // namespace engine
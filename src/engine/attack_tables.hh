@@ -1,6 +1,109 @@
 #pragma once
 #include "bitboard.hh"
 
+#include <array>
+#include <cstdint>
+
 namespace engine {
-extern const Bitboard KNIGHT_ATTACKS[64];
-}
\ No newline at end of file
+
+// Leaper attacks, between/line masks and distances, all generated at compile
+// time from the shift helpers in bitboard.hh (no startup cost, no init order).
+namespace tables {
+
+using Step = Bitboard (*)(Bitboard);
+
+// opposite directions are adjacent pairs
+inline constexpr Step STEPS[8] = {&north, &south, &east, &west, &ne, &sw, &nw, &se};
+
+constexpr Bitboard knight_from(Bitboard b)
+{
+    const Bitboard l1 = (b >> 1) & ~FileBB[7];
+    const Bitboard l2 = (b >> 2) & ~(FileBB[6] | FileBB[7]);
+    const Bitboard r1 = (b << 1) & ~FileBB[0];
+    const Bitboard r2 = (b << 2) & ~(FileBB[0] | FileBB[1]);
+    return ((l2 | r2) << 8) | ((l2 | r2) >> 8) | ((l1 | r1) << 16) | ((l1 | r1) >> 16);
+}
+
+constexpr Bitboard king_from(Bitboard b)
+{
+    return north(b) | south(b) | east(b) | west(b) | ne(b) | nw(b) | se(b) | sw(b);
+}
+
+constexpr std::array<Bitboard, 64> leaper_table(Bitboard (*attacks)(Bitboard))
+{
+    std::array<Bitboard, 64> t{};
+    for (int sq = 0; sq < 64; ++sq)
+        t[sq] = attacks(1ULL << sq);
+    return t;
+}
+
+constexpr std::array<std::array<Bitboard, 64>, 2> pawn_table()
+{
+    std::array<std::array<Bitboard, 64>, 2> t{};
+    for (int sq = 0; sq < 64; ++sq) {
+        const Bitboard b = 1ULL << sq;
+        t[0][sq] = ne(b) | nw(b);
+        t[1][sq] = se(b) | sw(b);
+    }
+    return t;
+}
+
+// squares reached from 'sq' stepping in one direction, excluding sq
+constexpr Bitboard ray(int sq, Step step)
+{
+    Bitboard r = 0ULL;
+    for (Bitboard b = step(1ULL << sq); b; b = step(b))
+        r |= b;
+    return r;
+}
+
+// between == true: squares strictly between; false: the full line through both
+constexpr std::array<std::array<Bitboard, 64>, 64> line_table(bool between)
+{
+    std::array<std::array<Bitboard, 64>, 64> t{};
+    for (int a = 0; a < 64; ++a) {
+        for (int d = 0; d < 8; ++d) {
+            const Bitboard line = ray(a, STEPS[d]) | ray(a, STEPS[d ^ 1]) | (1ULL << a);
+            Bitboard gap = 0ULL;
+            for (Bitboard r = STEPS[d](1ULL << a); r; r = STEPS[d](r)) {
+                int b = 0;
+                while (!((r >> b) & 1ULL))
+                    ++b;
+                t[a][b] = between ? gap : line;
+                gap |= r;
+            }
+        }
+    }
+    return t;
+}
+
+constexpr std::array<std::array<std::uint8_t, 64>, 64> distance_table()
+{
+    std::array<std::array<std::uint8_t, 64>, 64> t{};
+    for (int a = 0; a < 64; ++a)
+        for (int b = 0; b < 64; ++b) {
+            const int df = (a & 7) > (b & 7) ? (a & 7) - (b & 7) : (b & 7) - (a & 7);
+            const int dr = (a >> 3) > (b >> 3) ? (a >> 3) - (b >> 3) : (b >> 3) - (a >> 3);
+            t[a][b] = static_cast<std::uint8_t>(df > dr ? df : dr);
+        }
+    return t;
+}
+
+} // namespace tables
+
+inline constexpr auto KNIGHT_ATTACKS = tables::leaper_table(&tables::knight_from);
+inline constexpr auto KING_ATTACKS = tables::leaper_table(&tables::king_from);
+
+// PAWN_ATTACKS[c][sq]: squares a pawn of colour c (0 = white) on sq attacks
+inline constexpr auto PAWN_ATTACKS = tables::pawn_table();
+
+// BETWEEN[a][b]: squares strictly between a and b if they share a rank, file
+// or diagonal, else 0. LINE[a][b]: the whole line through a and b (both
+// included), else 0.
+inline constexpr auto BETWEEN = tables::line_table(true);
+inline constexpr auto LINE = tables::line_table(false);
+
+// DISTANCE[a][b]: king steps from a to b (Chebyshev distance)
+inline constexpr auto DISTANCE = tables::distance_table();
+
+} // namespace engine
@@ -90,36 +90,36 @@ inline constexpr Bitboard RankBB[8] = {0x00000000000000FFULL, 0x000000000000FF00
                                        0x00000000FF000000ULL, 0x000000FF00000000ULL, 0x0000FF0000000000ULL,
                                        0x00FF000000000000ULL, 0xFF00000000000000ULL};
 
-inline Bitboard north(Bitboard b)
+constexpr Bitboard north(Bitboard b)
 {
     return b << 8;
 }
-inline Bitboard south(Bitboard b)
+constexpr Bitboard south(Bitboard b)
 {
     return b >> 8;
 }
-inline Bitboard east(Bitboard b)
+constexpr Bitboard east(Bitboard b)
 {
     return (b & ~FileBB[7]) << 1;
 }
-inline Bitboard west(Bitboard b)
+constexpr Bitboard west(Bitboard b)
 {
     return (b & ~FileBB[0]) >> 1;
 }
 
-inline Bitboard ne(Bitboard b)
+constexpr Bitboard ne(Bitboard b)
 {
     return (b & ~FileBB[7]) << 9;
 }
-inline Bitboard nw(Bitboard b)
+constexpr Bitboard nw(Bitboard b)
 {
     return (b & ~FileBB[0]) << 7;
 }
-inline Bitboard se(Bitboard b)
+constexpr Bitboard se(Bitboard b)
 {
     return (b & ~FileBB[7]) >> 7;
 }
-inline Bitboard sw(Bitboard b)
+constexpr Bitboard sw(Bitboard b)
 {
     return (b & ~FileBB[0]) >> 9;
 }
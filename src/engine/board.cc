@@ -1,27 +1,13 @@
 #include "board.hh"
 
 #include "bitboard.hh"
+#include "move_do.hh"
 #include "zobrist.hh"
 
 #include <cstdint>
 
 namespace engine {
 
-static inline int popcnt_u64(std::uint64_t x)
-{
-#if defined(__GNUG__) || defined(__clang__)
-    return __builtin_popcountll(x);
-#else
-    // Portable fallback
-    int c = 0;
-    while (x) {
-        x &= (x - 1);
-        ++c;
-    }
-    return c;
-#endif
-}
-
 Board Board::startpos()
 {
     Board b{};
@@ -42,9 +28,20 @@ Board Board::startpos()
     b.pieces[BLACK][QUEEN] = 0x0800000000000000ULL;
     b.pieces[BLACK][KING] = 0x1000000000000000ULL;
 
+    for (int c = WHITE; c <= BLACK; ++c)
+        for (int p = PAWN; p <= KING; ++p)
+            for (Bitboard bb = b.pieces[c][p]; bb; bb &= bb - 1)
+                b.squares[__builtin_ctzll(bb)] = static_cast<Piece>(p);
+
+    b.by_colour[WHITE] = 0x000000000000FFFFULL;
+    b.by_colour[BLACK] = 0xFFFF000000000000ULL;
+    b.occupied = b.by_colour[WHITE] | b.by_colour[BLACK];
+
     b.side_to_move = WHITE;
-    zobrist::init();
     b.zkey_ = zobrist::compute(b);
+    b.pawn_key_ = zobrist::compute_pawn(b);
+    b.material_key_ = zobrist::compute_material(b);
+    set_check_info(b);
 
     return b;
 }
@@ -54,34 +51,31 @@ std::uint64_t Board::zkey() const
     return zkey_;
 }
 
-bool trivial_insufficient_material(const Board& b)
+// both kings plus at most one minor piece
+static constexpr std::uint64_t kings_and(Colour c, Piece p)
 {
+    int counts[2][6] = {};
+    counts[WHITE][KING] = counts[BLACK][KING] = 1;
+    if (p != NO_PIECE)
+        counts[c][p] = 1;
+    return zobrist::material_of(counts);
+}
 
-    // any pawns, queens, rooks present? if so, not draw
-    if ((b.pieces[WHITE][PAWN] | b.pieces[BLACK][PAWN] | b.pieces[WHITE][QUEEN] | b.pieces[BLACK][QUEEN] |
-         b.pieces[WHITE][ROOK] | b.pieces[BLACK][ROOK]) != 0ULL) {
-        return false;
-    }
-
-    const int wB = popcnt_u64(b.pieces[WHITE][BISHOP]);
-    const int bB = popcnt_u64(b.pieces[BLACK][BISHOP]);
-    const int wN = popcnt_u64(b.pieces[WHITE][KNIGHT]);
-    const int bN = popcnt_u64(b.pieces[BLACK][KNIGHT]);
-
-    const int wNonKing = wB + wN;
-    const int bNonKing = bB + bN;
-
-    const int total = wNonKing + bNonKing;
-
-    // KK
-    if (total == 0)
-        return true;
-
-    // exactly 1 minor on entire board
-    if (total == 1)
-        return true;
+static constexpr std::uint64_t INSUFFICIENT[] = {
+        kings_and(WHITE, NO_PIECE),
+        kings_and(WHITE, KNIGHT),
+        kings_and(BLACK, KNIGHT),
+        kings_and(WHITE, BISHOP),
+        kings_and(BLACK, BISHOP),
+};
 
+bool trivial_insufficient_material(const Board& b)
+{
     // intentionally do not count K+N vs K+N or K+B vs K+B as draw
+    const std::uint64_t k = b.material_key();
+    for (std::uint64_t draw : INSUFFICIENT)
+        if (k == draw)
+            return true;
     return false;
 }
 
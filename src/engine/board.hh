@@ -3,50 +3,124 @@
 
 #include <array>
 #include <cstdint>
-#include <optional>
+#include <type_traits>
 
 namespace engine {
 
-enum Colour { WHITE, BLACK };
+enum Colour : std::uint8_t { WHITE, BLACK };
 
-enum Piece { PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING, NO_PIECE };
+enum Piece : std::uint8_t { PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING, NO_PIECE };
 
-struct CastlingRights {
-    bool wk{true};
-    bool wq{true};
-    bool bk{true};
-    bool bq{true};
+// Compile-time colour helpers for the colour-templated hot paths
+template <Colour C> inline constexpr Colour OPPONENT = (C == WHITE) ? BLACK : WHITE;
+
+// one step towards the opponent's side
+template <Colour C> inline Bitboard pawn_push(Bitboard b)
+{
+    if constexpr (C == WHITE)
+        return north(b);
+    else
+        return south(b);
+}
+
+// squares attacked by pawns of colour C standing on b
+template <Colour C> inline Bitboard pawn_attacks(Bitboard b)
+{
+    if constexpr (C == WHITE)
+        return ne(b) | nw(b);
+    else
+        return se(b) | sw(b);
+}
+
+// Castling rights as a 4-bit mask
+enum CastlingRight : std::uint8_t {
+    NO_CASTLING = 0,
+    WHITE_OO = 1,
+    WHITE_OOO = 2,
+    BLACK_OO = 4,
+    BLACK_OOO = 8,
+    ALL_CASTLING = 15,
+};
+
+// Rights kept when a move touches 'sq' (from or to): king and rook home
+// squares clear their rights, every other square keeps all of them.
+inline constexpr std::array<std::uint8_t, 64> CASTLE_MASK = [] {
+    std::array<std::uint8_t, 64> m{};
+    m.fill(ALL_CASTLING);
+    m[E1] = ALL_CASTLING & ~(WHITE_OO | WHITE_OOO);
+    m[H1] = ALL_CASTLING & ~WHITE_OO;
+    m[A1] = ALL_CASTLING & ~WHITE_OOO;
+    m[E8] = ALL_CASTLING & ~(BLACK_OO | BLACK_OOO);
+    m[H8] = ALL_CASTLING & ~BLACK_OO;
+    m[A8] = ALL_CASTLING & ~BLACK_OOO;
+    return m;
+}();
+
+// every square empty, for the mailbox's default member initialiser
+constexpr std::array<Piece, 64> empty_squares()
+{
+    std::array<Piece, 64> sq{};
+    sq.fill(NO_PIECE);
+    return sq;
+}
+
+// Check and pin info for the side to move, recomputed after every move
+struct StateInfo {
+    Bitboard checkers{0};        // enemy pieces giving check
+    Bitboard blockers[2]{};      // sole piece (either colour) between king c and an enemy slider
+    Bitboard check_squares[6]{}; // squares from which each of our piece types would check their king
 };
 
-struct Board {
+// Plain data, aligned to a cache line so copy-make copies whole lines.
+struct alignas(64) Board {
     Bitboard pieces[2][6]{};
+    std::array<Piece, 64> squares = empty_squares(); // piece type per square, mirrors pieces[][]
+    Bitboard by_colour[2]{};                         // union of pieces[c][]
+    Bitboard occupied{0};                            // by_colour[WHITE] | by_colour[BLACK]
     Colour side_to_move{WHITE};
-    CastlingRights castle{};
-    std::optional<int> ep_square{}; // en passent square 0...63 if available.
+    std::uint8_t castle{ALL_CASTLING}; // CastlingRight bits
+    std::uint8_t ep_square{SQ_NONE};   // en passent square 0...63, SQ_NONE if unavailable
     int halfmove_clock{0};
     int fullmove_number{1};
+    StateInfo st{};
 
     static Board startpos();
 
     // zobrist key
     std::uint64_t zkey_{0};
     std::uint64_t zkey() const;
+
+    // pawns only, and piece counts only (see zobrist.hh); kept by make/unmake
+    std::uint64_t pawn_key_{0};
+    std::uint64_t material_key_{0};
+    std::uint64_t pawn_key() const
+    {
+        return pawn_key_;
+    }
+    std::uint64_t material_key() const
+    {
+        return material_key_;
+    }
 };
 
+static_assert(std::is_trivially_copyable_v<Board>);
+
+inline bool can_castle(const Board& b, CastlingRight cr)
+{
+    return (b.castle & cr) != 0;
+}
+
 inline Bitboard occupancy(const Board& b, Colour c)
 {
-    Bitboard occ = 0;
-    for (int p = PAWN; p <= KING; ++p)
-        occ |= b.pieces[c][p];
-    return occ;
+    return b.by_colour[c];
 }
 inline Bitboard occupancy(const Board& b)
 {
-    return occupancy(b, WHITE) | occupancy(b, BLACK);
+    return b.occupied;
 }
 
 // Returns true for trivial insufficient material draws
-// KK, KBK, KNK
+// KK, KBK, KNK (a material key lookup)
 bool trivial_insufficient_material(const Board& b);
 
 } // namespace engine
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "fen.hh"
 
+#include "move_do.hh"
 #include "zobrist.hh"
 
 #include <cctype>
@@ -70,26 +71,37 @@ Board from_fen(const std::string& fen)
         }
 
         b.pieces[colour][p] |= (1ULL << sq_index(f, r)); // set bitboard to 1 at colour and piece
+        b.squares[sq_index(f, r)] = p;
+        b.by_colour[colour] |= (1ULL << sq_index(f, r));
         ++f;
     }
 
+    b.occupied = b.by_colour[WHITE] | b.by_colour[BLACK];
+
     b.side_to_move = (stm == "w") ? WHITE : BLACK;
-    b.castle = {};
-    b.castle.wk = cast.find('K') != std::string::npos;
-    b.castle.wq = cast.find('Q') != std::string::npos;
-    b.castle.bk = cast.find('k') != std::string::npos;
-    b.castle.bq = cast.find('q') != std::string::npos;
+    b.castle = NO_CASTLING;
+    if (cast.find('K') != std::string::npos)
+        b.castle |= WHITE_OO;
+    if (cast.find('Q') != std::string::npos)
+        b.castle |= WHITE_OOO;
+    if (cast.find('k') != std::string::npos)
+        b.castle |= BLACK_OO;
+    if (cast.find('q') != std::string::npos)
+        b.castle |= BLACK_OOO;
 
     if (ep != "-") {
         int file = ep[0] - 'a';
         int rank = ep[1] - '1';
-        b.ep_square = sq_index(file, rank);
+        b.ep_square = static_cast<std::uint8_t>(sq_index(file, rank));
     }
 
     b.halfmove_clock = half;
     b.fullmove_number = full;
 
     b.zkey_ = zobrist::compute(b);
+    b.pawn_key_ = zobrist::compute_pawn(b);
+    b.material_key_ = zobrist::compute_material(b);
+    set_check_info(b);
 
     return b;
 }
@@ -134,19 +146,19 @@ std::string to_fen(const Board& b)
     out << ' ' << (b.side_to_move == WHITE ? 'w' : 'b') << ' ';
     std::string cr;
 
-    if (b.castle.wk)
+    if (can_castle(b, WHITE_OO))
         cr.push_back('K');
-    if (b.castle.wq)
+    if (can_castle(b, WHITE_OOO))
         cr.push_back('Q');
-    if (b.castle.bk)
+    if (can_castle(b, BLACK_OO))
         cr.push_back('k');
-    if (b.castle.bq)
+    if (can_castle(b, BLACK_OOO))
         cr.push_back('q');
 
     out << (cr.empty() ? "-" : cr) << ' ';
-    if (b.ep_square) {
-        int file = *b.ep_square % 8;
-        int rank = *b.ep_square / 8;
+    if (b.ep_square != SQ_NONE) {
+        int file = b.ep_square % 8;
+        int rank = b.ep_square / 8;
         out << char('a' + file) << char('1' + rank);
     } else
         out << '-';
@@ -0,0 +1,153 @@
+#include "magic.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace engine {
+
+bool SLIDERS_USE_PEXT = PEXT_COMPILED;
+
+Magic BISHOP_MAGICS[64];
+Magic ROOK_MAGICS[64];
+
+// Shared attack tables (sum of 2^popcount(mask) over all squares)
+static Bitboard BISHOP_TABLE[0x1480];
+static Bitboard ROOK_TABLE[0x19000];
+
+using Step = Bitboard (*)(Bitboard);
+
+static constexpr Step BISHOP_STEPS[4] = {&ne, &nw, &se, &sw};
+static constexpr Step ROOK_STEPS[4] = {&north, &south, &east, &west};
+
+// Reference ray walk: attacks stop at (and include) the first blocker.
+static Bitboard ray_attacks(int sq, Bitboard occ, const Step steps[4])
+{
+    Bitboard att = 0ULL;
+    for (int i = 0; i < 4; ++i) {
+        Bitboard r = 1ULL << sq;
+        while (true) {
+            r = steps[i](r);
+            if (!r)
+                break;
+            att |= r;
+            if (r & occ)
+                break;
+        }
+    }
+    return att;
+}
+
+// xorshift64*, fixed seed so the magics are identical on every run
+static inline std::uint64_t next_rand(std::uint64_t& s)
+{
+    s ^= s >> 12;
+    s ^= s << 25;
+    s ^= s >> 27;
+    return s * 2685821657736338717ULL;
+}
+
+// Magic candidates with few set bits are far more likely to succeed
+static inline std::uint64_t sparse_rand(std::uint64_t& s)
+{
+    return next_rand(s) & next_rand(s) & next_rand(s);
+}
+
+// Per-rank seeds known to find all magics after a handful of trials
+static constexpr std::uint64_t RANK_SEEDS[8] = {728, 10316, 55013, 32803, 12281, 15100, 16645, 255};
+
+static void init_slider(Magic table[64], Bitboard* storage, const Step steps[4])
+{
+    Bitboard occupancy[4096];
+    Bitboard reference[4096];
+    int epoch[4096] = {};
+    int cnt = 0;
+
+    for (int sq = 0; sq < 64; ++sq) {
+        Magic& m = table[sq];
+
+        // edges only matter if the slider stands on them
+        const Bitboard edges =
+                ((RankBB[0] | RankBB[7]) & ~RankBB[sq >> 3]) | ((FileBB[0] | FileBB[7]) & ~FileBB[sq & 7]);
+        m.mask = ray_attacks(sq, 0ULL, steps) & ~edges;
+        m.shift = 64 - static_cast<unsigned>(__builtin_popcountll(m.mask));
+        m.attacks = (sq == 0) ? storage : table[sq - 1].attacks + (1ULL << (64 - table[sq - 1].shift));
+
+        // enumerate every subset of the mask (carry-rippler) with its true attack set
+        int size = 0;
+        Bitboard b = 0ULL;
+        do {
+            occupancy[size] = b;
+            reference[size] = ray_attacks(sq, b, steps);
+            ++size;
+            b = (b - m.mask) & m.mask;
+        } while (b);
+
+        if (SLIDERS_USE_PEXT) {
+            // PEXT indices are collision-free by construction
+            m.magic = 0ULL;
+            for (int i = 0; i < size; ++i)
+                m.attacks[m.index(occupancy[i])] = reference[i];
+            continue;
+        }
+
+        // trial-and-error search for a collision-free multiplier
+        std::uint64_t seed = RANK_SEEDS[sq >> 3];
+        for (int i = 0; i < size;) {
+            do {
+                m.magic = sparse_rand(seed);
+            } while (__builtin_popcountll((m.magic * m.mask) >> 56) < 6);
+
+            ++cnt;
+            for (i = 0; i < size; ++i) {
+                const unsigned idx = m.index(occupancy[i]);
+                if (epoch[idx] < cnt) {
+                    epoch[idx] = cnt;
+                    m.attacks[idx] = reference[i];
+                } else if (m.attacks[idx] != reference[i]) {
+                    break;
+                }
+            }
+        }
+    }
+}
+
+// PEXT is only worth it where it runs in hardware: Zen 1/2 microcode it at
+// roughly 20x the latency of a multiply. CHESSTER_SLIDERS=magic|pext overrides.
+static bool pick_pext()
+{
+    if (PEXT_COMPILED)
+        return true;
+#if defined(CHESSTER_PEXT_DISPATCH)
+    if (!__builtin_cpu_supports("bmi2"))
+        return false;
+    if (const char* env = std::getenv("CHESSTER_SLIDERS")) {
+        if (std::strcmp(env, "magic") == 0)
+            return false;
+        if (std::strcmp(env, "pext") == 0)
+            return true;
+    }
+    return !(__builtin_cpu_is("znver1") || __builtin_cpu_is("znver2"));
+#else
+    return false;
+#endif
+}
+
+const char* slider_backend()
+{
+    return SLIDERS_USE_PEXT ? "pext" : "magic";
+}
+
+namespace {
+struct MagicInit {
+    MagicInit()
+    {
+        SLIDERS_USE_PEXT = pick_pext();
+        init_slider(BISHOP_MAGICS, BISHOP_TABLE, BISHOP_STEPS);
+        init_slider(ROOK_MAGICS, ROOK_TABLE, ROOK_STEPS);
+    }
+};
+const MagicInit g_magic_init;
+} // namespace
+
+} // namespace engine
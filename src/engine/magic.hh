@@ -0,0 +1,91 @@
+#pragma once
+#include "bitboard.hh"
+
+#include <cstdint>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+namespace engine {
+
+// Slider table indexing backends.
+//   CHESSTER_NATIVE on a BMI2 host: PEXT is compiled in unconditionally.
+//   x86-64 otherwise: PEXT or magic multiply, picked once at startup via CPUID.
+//   elsewhere: magic multiply only.
+#if defined(__BMI2__)
+inline constexpr bool PEXT_COMPILED = true;
+#elif (defined(__GNUG__) || defined(__clang__)) && defined(__x86_64__)
+#define CHESSTER_PEXT_DISPATCH 1
+inline constexpr bool PEXT_COMPILED = false;
+#else
+inline constexpr bool PEXT_COMPILED = false;
+#endif
+
+// true if the tables were built for PEXT indices (set before any lookup)
+extern bool SLIDERS_USE_PEXT;
+
+// "pext" or "magic", for diagnostics
+const char* slider_backend();
+
+inline std::uint64_t pext_u64(std::uint64_t x, std::uint64_t mask)
+{
+#if defined(__BMI2__)
+    return _pext_u64(x, mask);
+#elif defined(CHESSTER_PEXT_DISPATCH)
+    // encoded directly so callers inline without -mbmi2; only reached after the CPUID check
+    std::uint64_t r;
+    asm("pextq %2, %1, %0" : "=r"(r) : "r"(x), "rm"(mask));
+    return r;
+#else
+    (void)x;
+    (void)mask;
+    return 0;
+#endif
+}
+
+// Fancy magic bitboards for sliding pieces.
+// Each square owns a slice of a shared attack table; the masked occupancy is
+// hashed to a dense index either by multiplying with the square's magic number
+// or, on BMI2 hardware, by extracting the mask bits with PEXT.
+// The tables are built once during static initialisation, so lookups never
+// need an init check.
+struct Magic {
+    Bitboard mask;     // relevant blockers (ray squares excluding the board edge)
+    Bitboard magic;    // multiplier mapping masked occupancy to a dense index
+    Bitboard* attacks; // this square's slice of the shared attack table
+    unsigned shift;    // 64 - popcount(mask)
+
+    unsigned index(Bitboard occ) const
+    {
+        if (PEXT_COMPILED)
+            return static_cast<unsigned>(pext_u64(occ, mask));
+#if defined(CHESSTER_PEXT_DISPATCH)
+        if (SLIDERS_USE_PEXT)
+            return static_cast<unsigned>(pext_u64(occ, mask));
+#endif
+        return static_cast<unsigned>(((occ & mask) * magic) >> shift);
+    }
+};
+
+extern Magic BISHOP_MAGICS[64];
+extern Magic ROOK_MAGICS[64];
+
+inline Bitboard bishop_attacks(int sq, Bitboard occ)
+{
+    const Magic& m = BISHOP_MAGICS[sq];
+    return m.attacks[m.index(occ)];
+}
+
+inline Bitboard rook_attacks(int sq, Bitboard occ)
+{
+    const Magic& m = ROOK_MAGICS[sq];
+    return m.attacks[m.index(occ)];
+}
+
+inline Bitboard queen_attacks(int sq, Bitboard occ)
+{
+    return bishop_attacks(sq, occ) | rook_attacks(sq, occ);
+}
+
+} // namespace engine
@@ -1,7 +1,9 @@
 #include "move_do.hh"
 
+#include "attack_fill.hh"
 #include "attack_tables.hh"
 #include "bitboard.hh"
+#include "magic.hh"
 #include "util.hh"
 #include "zobrist.hh"
 
@@ -19,96 +21,280 @@ static inline void bb_clear(Bitboard& bb, int sq)
     bb &= ~(1ULL << sq);
 }
 
-bool is_square_attacked(const Board& b, int sq, Colour by)
+template <Colour By> bool is_square_attacked(const Board& b, int sq)
 {
     const Bitboard occAll = occupancy(b);
-    const Bitboard target = 1ULL << sq;
 
-    // pawns: shift the target TOWARD the side that could capture into it
-    if (by == WHITE) {
-        // A white pawn attacks from one rank below target (south) diagonally
-        if ((se(target) & b.pieces[WHITE][PAWN]) || (sw(target) & b.pieces[WHITE][PAWN]))
-            return true;
-    } else {
-        // A black pawn attacks from one rank above target (north) diagonally
-        if ((ne(target) & b.pieces[BLACK][PAWN]) || (nw(target) & b.pieces[BLACK][PAWN]))
-            return true;
-    }
+    // pawns: a pawn of 'By' attacks sq from where an opposing pawn on sq would attack
+    if (PAWN_ATTACKS[OPPONENT<By>][sq] & b.pieces[By][PAWN])
+        return true;
 
     // knights
-    if (KNIGHT_ATTACKS[sq] & b.pieces[by][KNIGHT])
+    if (KNIGHT_ATTACKS[sq] & b.pieces[By][KNIGHT])
         return true;
 
     // kings (adjacent)
-    {
-        Bitboard k = target;
-        Bitboard kingAtt = (north(k) | south(k) | east(k) | west(k) | ne(k) | nw(k) | se(k) | sw(k));
-        if (kingAtt & b.pieces[by][KING])
-            return true;
+    if (KING_ATTACKS[sq] & b.pieces[By][KING])
+        return true;
+
+    // sliders
+    const Bitboard rq = b.pieces[By][ROOK] | b.pieces[By][QUEEN];
+    const Bitboard bq = b.pieces[By][BISHOP] | b.pieces[By][QUEEN];
+
+    if (rook_attacks(sq, occAll) & rq)
+        return true;
+
+    if (bishop_attacks(sq, occAll) & bq)
+        return true;
+
+    return false;
+}
+
+bool is_square_attacked(const Board& b, int sq, Colour by)
+{
+    return (by == WHITE) ? is_square_attacked<WHITE>(b, sq) : is_square_attacked<BLACK>(b, sq);
+}
+
+template bool is_square_attacked<WHITE>(const Board&, int);
+template bool is_square_attacked<BLACK>(const Board&, int);
+
+Bitboard attackers_to(const Board& b, int sq, Bitboard occ)
+{
+    const Bitboard rq = b.pieces[WHITE][ROOK] | b.pieces[WHITE][QUEEN] | b.pieces[BLACK][ROOK] | b.pieces[BLACK][QUEEN];
+    const Bitboard bq =
+            b.pieces[WHITE][BISHOP] | b.pieces[WHITE][QUEEN] | b.pieces[BLACK][BISHOP] | b.pieces[BLACK][QUEEN];
+
+    // a white pawn attacks sq from where a black pawn on sq would attack, and vice versa
+    return (PAWN_ATTACKS[BLACK][sq] & b.pieces[WHITE][PAWN]) | (PAWN_ATTACKS[WHITE][sq] & b.pieces[BLACK][PAWN]) |
+           (KNIGHT_ATTACKS[sq] & (b.pieces[WHITE][KNIGHT] | b.pieces[BLACK][KNIGHT])) |
+           (KING_ATTACKS[sq] & (b.pieces[WHITE][KING] | b.pieces[BLACK][KING])) | (rook_attacks(sq, occ) & rq) |
+           (bishop_attacks(sq, occ) & bq);
+}
+
+// Pawns and knights by shifts over the whole set; sliders by the AVX2
+// Kogge-Stone fill where available (attack_fill.hh), else one magic lookup each.
+template <Colour By> Bitboard attacked_squares(const Board& b, Bitboard occ)
+{
+    Bitboard att = pawn_attacks<By>(b.pieces[By][PAWN]) | tables::knight_from(b.pieces[By][KNIGHT]);
+
+    if (const Bitboard k = b.pieces[By][KING])
+        att |= KING_ATTACKS[__builtin_ctzll(k)];
+
+    const Bitboard rq = b.pieces[By][ROOK] | b.pieces[By][QUEEN];
+    const Bitboard bq = b.pieces[By][BISHOP] | b.pieces[By][QUEEN];
+    if (fill_avx2())
+        return att | slider_fill_avx2(rq, bq, occ);
+
+    Bitboard pcs = bq;
+    while (pcs)
+        att |= bishop_attacks(pop_lsb(pcs), occ);
+
+    pcs = rq;
+    while (pcs)
+        att |= rook_attacks(pop_lsb(pcs), occ);
+
+    return att;
+}
+
+Bitboard attacked_squares(const Board& b, Colour by, Bitboard occ)
+{
+    return (by == WHITE) ? attacked_squares<WHITE>(b, occ) : attacked_squares<BLACK>(b, occ);
+}
+
+template Bitboard attacked_squares<WHITE>(const Board&, Bitboard);
+template Bitboard attacked_squares<BLACK>(const Board&, Bitboard);
+
+Bitboard slider_blockers(const Board& b, int ksq, Colour by)
+{
+    const Bitboard occ = occupancy(b);
+
+    // sliders of 'by' that would hit ksq on an empty board
+    Bitboard snipers = (rook_attacks(ksq, 0ULL) & (b.pieces[by][ROOK] | b.pieces[by][QUEEN])) |
+                       (bishop_attacks(ksq, 0ULL) & (b.pieces[by][BISHOP] | b.pieces[by][QUEEN]));
+
+    Bitboard blockers = 0ULL;
+    while (snipers) {
+        const Bitboard between = BETWEEN[ksq][pop_lsb(snipers)] & occ;
+        // exactly one piece in between
+        if (between && !(between & (between - 1)))
+            blockers |= between;
     }
+    return blockers;
+}
 
-    // sliders unchanged ...
-    auto ray_hit = [&](Bitboard (*step)(Bitboard), Bitboard sliders) {
-        Bitboard r = target;
-        while (true) {
-            r = step(r);
-            if (!r)
-                break;
-            if (r & occAll) {
-                if (r & sliders)
-                    return true;
-                break;
-            }
-        }
+Bitboard pinned_pieces(const Board& b, Colour c)
+{
+    return b.st.blockers[c] & occupancy(b, c);
+}
+
+void set_check_info(Board& b)
+{
+    const Colour us = b.side_to_move;
+    const Colour them = (us == WHITE) ? BLACK : WHITE;
+    const int ksq = king_sq(b, us);
+    const int theirKsq = king_sq(b, them);
+    StateInfo& st = b.st;
+
+    st.checkers = (ksq >= 0) ? attackers_to(b, ksq, occupancy(b)) & occupancy(b, them) : 0ULL;
+    st.blockers[us] = (ksq >= 0) ? slider_blockers(b, ksq, them) : 0ULL;
+    st.blockers[them] = (theirKsq >= 0) ? slider_blockers(b, theirKsq, us) : 0ULL;
+
+    if (theirKsq < 0) {
+        for (Bitboard& cs : st.check_squares)
+            cs = 0ULL;
+        return;
+    }
+    st.check_squares[PAWN] = PAWN_ATTACKS[them][theirKsq];
+    st.check_squares[KNIGHT] = KNIGHT_ATTACKS[theirKsq];
+    st.check_squares[BISHOP] = bishop_attacks(theirKsq, occupancy(b));
+    st.check_squares[ROOK] = rook_attacks(theirKsq, occupancy(b));
+    st.check_squares[QUEEN] = st.check_squares[BISHOP] | st.check_squares[ROOK];
+    st.check_squares[KING] = 0ULL;
+}
+
+bool gives_check(const Board& b, Move m)
+{
+    const Colour us = b.side_to_move;
+    const Colour them = (us == WHITE) ? BLACK : WHITE;
+    const int from = from_sq(m);
+    const int to = to_sq(m);
+    const int fl = flag(m);
+    const int ksq = king_sq(b, them);
+    if (ksq < 0)
         return false;
-    };
 
-    const Bitboard rq = b.pieces[by][ROOK] | b.pieces[by][QUEEN];
-    const Bitboard bq = b.pieces[by][BISHOP] | b.pieces[by][QUEEN];
+    const Bitboard fromBB = 1ULL << from;
+    const Bitboard toBB = 1ULL << to;
 
-    if (ray_hit(&north, rq) || ray_hit(&south, rq) || ray_hit(&east, rq) || ray_hit(&west, rq))
+    if (fl == KING_CASTLE || fl == QUEEN_CASTLE) {
+        // rook lands next to the king; our king leaving may also uncover a slider
+        const int rfrom = (fl == KING_CASTLE) ? from + 3 : from - 4;
+        const int rto = (fl == KING_CASTLE) ? from + 1 : from - 1;
+        const Bitboard occ = occupancy(b) ^ fromBB ^ toBB ^ (1ULL << rfrom) ^ (1ULL << rto);
+        const Bitboard rooks = b.pieces[us][ROOK] ^ (1ULL << rfrom) ^ (1ULL << rto);
+        return (rook_attacks(ksq, occ) & (rooks | b.pieces[us][QUEEN])) ||
+               (bishop_attacks(ksq, occ) & (b.pieces[us][BISHOP] | b.pieces[us][QUEEN]));
+    }
+
+    // direct check
+    if (b.st.check_squares[b.squares[from]] & toBB)
         return true;
 
-    if (ray_hit(&ne, bq) || ray_hit(&nw, bq) || ray_hit(&se, bq) || ray_hit(&sw, bq))
+    // discovered check: a blocker of their king leaves the line
+    if ((b.st.blockers[them] & fromBB) && !(LINE[ksq][from] & toBB))
         return true;
 
+    if (is_promo_any(m)) {
+        const Bitboard occ = occupancy(b) ^ fromBB;
+        switch (promo_piece_from_flag(fl)) {
+        case KNIGHT:
+            return KNIGHT_ATTACKS[to] & (1ULL << ksq);
+        case BISHOP:
+            return bishop_attacks(to, occ) & (1ULL << ksq);
+        case ROOK:
+            return rook_attacks(to, occ) & (1ULL << ksq);
+        default:
+            return queen_attacks(to, occ) & (1ULL << ksq);
+        }
+    }
+
+    if (fl == EN_PASSANT) {
+        // the captured pawn can uncover a slider as well
+        const int capSq = (us == WHITE) ? (to - 8) : (to + 8);
+        const Bitboard occ = (occupancy(b) ^ fromBB ^ (1ULL << capSq)) | toBB;
+        return (rook_attacks(ksq, occ) & (b.pieces[us][ROOK] | b.pieces[us][QUEEN])) ||
+               (bishop_attacks(ksq, occ) & (b.pieces[us][BISHOP] | b.pieces[us][QUEEN]));
+    }
+
     return false;
 }
 
-static inline void clear_castle_if_rook_moves(Board& b, Colour us, int fromSq)
+std::uint64_t key_after(const Board& b, Move m)
 {
-    if (us == WHITE) {
-        if (fromSq == H1)
-            b.castle.wk = false;
-        if (fromSq == A1)
-            b.castle.wq = false;
+    const Colour us = b.side_to_move;
+    const Colour them = (us == WHITE) ? BLACK : WHITE;
+    const int up = (us == WHITE) ? 8 : -8;
+    const int from = from_sq(m);
+    const int to = to_sq(m);
+    const int fl = flag(m);
+    const Piece p = b.squares[from];
+
+    // side, old EP square, castling rights: as make_move toggles them
+    std::uint64_t k = b.zkey() ^ zobrist::side() ^ zobrist::ep_component(b, us);
+    k ^= zobrist::castle_mask(b.castle) ^ zobrist::castle_mask(b.castle & CASTLE_MASK[from] & CASTLE_MASK[to]);
+
+    if (fl == EN_PASSANT)
+        k ^= zobrist::psq(them, PAWN, to - up);
+    else if (is_capture(m))
+        k ^= zobrist::psq(them, b.squares[to], to);
+
+    if (fl == KING_CASTLE || fl == QUEEN_CASTLE) {
+        const int rfrom = (fl == KING_CASTLE) ? from + 3 : from - 4;
+        const int rto = (fl == KING_CASTLE) ? from + 1 : from - 1;
+        k ^= zobrist::psq(us, KING, from) ^ zobrist::psq(us, KING, to);
+        k ^= zobrist::psq(us, ROOK, rfrom) ^ zobrist::psq(us, ROOK, rto);
+    } else if (is_promo_any(m)) {
+        k ^= zobrist::psq(us, PAWN, from) ^ zobrist::psq(us, promo_piece_from_flag(fl), to);
     } else {
-        if (fromSq == H8)
-            b.castle.bk = false;
-        if (fromSq == A8)
-            b.castle.bq = false;
+        k ^= zobrist::psq(us, p, from) ^ zobrist::psq(us, p, to);
+        // the new EP square only counts if one of their pawns can take on it
+        if (fl == DOUBLE_PUSH && (PAWN_ATTACKS[us][from + up] & b.pieces[them][PAWN]))
+            k ^= zobrist::ep_file(from + up);
     }
+    return k;
 }
 
-static inline void clear_castle_if_rook_captured(Board& b, Colour them, int atSq)
+// Piece XOR helpers that keep bitboards, mailbox, occupancy and the Zobrist
+// keys in step. The material key toggles the key of the count that changes.
+template <Colour C> static inline void remove_piece(Board& b, Piece p, int sq)
 {
-    if (them == WHITE) {
-        if (atSq == H1)
-            b.castle.wk = false;
-        if (atSq == A1)
-            b.castle.wq = false;
-    } else {
-        if (atSq == H8)
-            b.castle.bk = false;
-        if (atSq == A8)
-            b.castle.bq = false;
-    }
+    bb_clear(b.pieces[C][p], sq);
+    bb_clear(b.by_colour[C], sq);
+    bb_clear(b.occupied, sq);
+    b.squares[sq] = NO_PIECE;
+    b.zkey_ ^= zobrist::psq(C, p, sq);
+    b.material_key_ ^= zobrist::psq(C, p, __builtin_popcountll(b.pieces[C][p]));
+    if (p == PAWN)
+        b.pawn_key_ ^= zobrist::psq(C, PAWN, sq);
 }
 
-void make_move(Board& b, Move m, Undo& u)
+template <Colour C> static inline void add_piece(Board& b, Piece p, int sq)
 {
-    const Colour us = b.side_to_move;
-    const Colour them = (us == WHITE) ? BLACK : WHITE;
+    b.material_key_ ^= zobrist::psq(C, p, __builtin_popcountll(b.pieces[C][p]));
+    bb_set(b.pieces[C][p], sq);
+    bb_set(b.by_colour[C], sq);
+    bb_set(b.occupied, sq);
+    b.squares[sq] = p;
+    b.zkey_ ^= zobrist::psq(C, p, sq);
+    if (p == PAWN)
+        b.pawn_key_ ^= zobrist::psq(C, PAWN, sq);
+}
+
+// remove_piece + add_piece for one piece changing squares; counts, and so the
+// material key, stay the same
+template <Colour C> static inline void move_piece(Board& b, Piece p, int from, int to)
+{
+    const Bitboard fromTo = (1ULL << from) | (1ULL << to);
+    b.pieces[C][p] ^= fromTo;
+    b.by_colour[C] ^= fromTo;
+    b.occupied ^= fromTo;
+    b.squares[from] = NO_PIECE;
+    b.squares[to] = p;
+    b.zkey_ ^= zobrist::psq(C, p, from) ^ zobrist::psq(C, p, to);
+    if (p == PAWN)
+        b.pawn_key_ ^= zobrist::psq(C, PAWN, from) ^ zobrist::psq(C, PAWN, to);
+}
+
+// Rook squares for castling, per side
+template <Colour C> inline constexpr int OO_ROOK_FROM = (C == WHITE) ? H1 : H8;
+template <Colour C> inline constexpr int OO_ROOK_TO = (C == WHITE) ? F1 : F8;
+template <Colour C> inline constexpr int OOO_ROOK_FROM = (C == WHITE) ? A1 : A8;
+template <Colour C> inline constexpr int OOO_ROOK_TO = (C == WHITE) ? D1 : D8;
+
+template <Colour Us> static void make_move_for(Board& b, Move m, Undo& u)
+{
+    constexpr Colour them = OPPONENT<Us>;
+    constexpr int up = (Us == WHITE) ? 8 : -8;
     const int from = from_sq(m);
     const int to = to_sq(m);
     const int fl = flag(m);
@@ -118,11 +304,12 @@ void make_move(Board& b, Move m, Undo& u)
     u.castle_prev = b.castle;
     u.halfmove_prev = b.halfmove_clock;
     u.fullmove_prev = b.fullmove_number;
+    u.st_prev = b.st;
     u.captured_piece = NO_PIECE;
-    u.moved_piece = piece_on(b, us, from);
+    u.moved_piece = piece_on(b, Us, from);
 
     // Update Zobrist key for removed EP square (if any & capturable)
-    b.zkey_ ^= zobrist::ep_component(b, us);
+    b.zkey_ ^= zobrist::ep_component(b, Us);
 
     // remove current castling rights
     b.zkey_ ^= zobrist::castle_mask(b.castle);
@@ -130,18 +317,7 @@ void make_move(Board& b, Move m, Undo& u)
     assert(u.moved_piece != NO_PIECE && "No piece on from-square");
 
     // defaults
-    b.ep_square.reset();
-
-    // Piece XOR helpers that also update bitboards and the Zobrist key
-    auto remove_piece = [&](Colour c, Piece p, int sq) {
-        bb_clear(b.pieces[c][p], sq);
-        b.zkey_ ^= zobrist::psq(c, p, sq);
-    };
-
-    auto add_piece = [&](Colour c, Piece p, int sq) {
-        bb_set(b.pieces[c][p], sq);
-        b.zkey_ ^= zobrist::psq(c, p, sq);
-    };
+    b.ep_square = SQ_NONE;
 
     // Handle captures first (incl. promo captures & EP)
     bool any_capture = false;
@@ -149,70 +325,35 @@ void make_move(Board& b, Move m, Undo& u)
         fl == PROMO_Q_CAPTURE) {
         u.captured_piece = piece_on(b, them, to);
         assert(u.captured_piece != NO_PIECE && "Capture flag but no piece on target");
-        remove_piece(them, u.captured_piece, to);
+        remove_piece<them>(b, u.captured_piece, to);
         any_capture = true;
     } else if (fl == EN_PASSANT) {
-        int capSq = (us == WHITE) ? (to - 8) : (to + 8);
         u.captured_piece = PAWN;
-        remove_piece(them, PAWN, capSq);
+        remove_piece<them>(b, PAWN, to - up);
         any_capture = true;
     }
 
-    // Move our piece off 'from'
-    remove_piece(us, u.moved_piece, from);
-
-    // Place to-square based on move type
-    if (fl == KING_CASTLE || fl == QUEEN_CASTLE) {
-        add_piece(us, KING, to);
-        if (us == WHITE) {
-            if (fl == KING_CASTLE) {
-                remove_piece(WHITE, ROOK, H1);
-                add_piece(WHITE, ROOK, F1);
-            } else {
-                remove_piece(WHITE, ROOK, A1);
-                add_piece(WHITE, ROOK, D1);
-            }
-            b.castle.wk = b.castle.wq = false;
-        } else {
-            if (fl == KING_CASTLE) {
-                remove_piece(BLACK, ROOK, H8);
-                add_piece(BLACK, ROOK, F8);
-            } else {
-                remove_piece(BLACK, ROOK, A8);
-                add_piece(BLACK, ROOK, D8);
-            }
-            b.castle.bk = b.castle.bq = false;
-        }
+    // Move our piece from 'from' based on move type
+    if (fl == KING_CASTLE) {
+        move_piece<Us>(b, KING, from, to);
+        move_piece<Us>(b, ROOK, OO_ROOK_FROM<Us>, OO_ROOK_TO<Us>);
+    } else if (fl == QUEEN_CASTLE) {
+        move_piece<Us>(b, KING, from, to);
+        move_piece<Us>(b, ROOK, OOO_ROOK_FROM<Us>, OOO_ROOK_TO<Us>);
     } else if (is_promo_any(m)) {
         assert(u.moved_piece == PAWN);
-        add_piece(us, promo_piece_from_flag(fl), to);
+        remove_piece<Us>(b, PAWN, from);
+        add_piece<Us>(b, promo_piece_from_flag(fl), to);
     } else {
-        add_piece(us, u.moved_piece, to);
+        move_piece<Us>(b, u.moved_piece, from, to);
         if (fl == DOUBLE_PUSH) {
             // EP square is the jumped-over square
-            b.ep_square = (us == WHITE) ? std::optional<int>(from + 8) : std::optional<int>(from - 8);
+            b.ep_square = static_cast<std::uint8_t>(from + up);
         }
     }
 
     // Update castling rights (king/rook move or rook captured)
-    if (u.moved_piece == KING) {
-        if (us == WHITE) {
-            b.castle.wk = false;
-            b.castle.wq = false;
-        } else {
-            b.castle.bk = false;
-            b.castle.bq = false;
-        }
-    } else if (u.moved_piece == ROOK) {
-        clear_castle_if_rook_moves(b, us, from);
-    }
-    if (any_capture) {
-        clear_castle_if_rook_captured(b, them, to);
-        if (fl == EN_PASSANT) {
-            int capSq = (us == WHITE) ? (to - 8) : (to + 8);
-            clear_castle_if_rook_captured(b, them, capSq);
-        }
-    }
+    b.castle &= CASTLE_MASK[from] & CASTLE_MASK[to];
 
     // Update Zobrist key for new castling rights
     b.zkey_ ^= zobrist::castle_mask(b.castle);
@@ -224,20 +365,23 @@ void make_move(Board& b, Move m, Undo& u)
         b.halfmove_clock += 1;
 
     // move number and side to move
-    if (us == BLACK)
+    if constexpr (Us == BLACK)
         b.fullmove_number += 1;
 
     b.zkey_ ^= zobrist::side();
     b.side_to_move = them;
 
     // Update Zobrist key for new EP square (if any & capturable)
-    b.zkey_ ^= zobrist::ep_component(b, b.side_to_move);
+    b.zkey_ ^= zobrist::ep_component(b, them);
+
+    set_check_info(b);
 }
 
-void unmake_move(Board& b, Move m, Undo& u)
+// Us is the side that made the move (not the side to move now)
+template <Colour Us> static void unmake_move_for(Board& b, Move m, Undo& u)
 {
-    const Colour them = b.side_to_move;                // side who is to move now
-    const Colour us = (them == WHITE) ? BLACK : WHITE; // side who just moved
+    constexpr Colour them = OPPONENT<Us>;
+    constexpr int up = (Us == WHITE) ? 8 : -8;
     const int from = from_sq(m);
     const int to = to_sq(m);
     const int fl = flag(m);
@@ -251,86 +395,59 @@ void unmake_move(Board& b, Move m, Undo& u)
     // toggle side (back to 'us')
     b.zkey_ ^= zobrist::side();
 
-    auto remove_piece = [&](Colour c, Piece p, int sq) {
-        bb_clear(b.pieces[c][p], sq);
-        b.zkey_ ^= zobrist::psq(c, p, sq);
-    };
-    auto add_piece = [&](Colour c, Piece p, int sq) {
-        bb_set(b.pieces[c][p], sq);
-        b.zkey_ ^= zobrist::psq(c, p, sq);
-    };
-
     // Restore side and counters/rights/ep
-    b.side_to_move = us;
+    b.side_to_move = Us;
     b.ep_square = u.ep_prev;
     b.castle = u.castle_prev;
     b.halfmove_clock = u.halfmove_prev;
     b.fullmove_number = u.fullmove_prev;
+    b.st = u.st_prev;
 
     // add previous castling rights
     b.zkey_ ^= zobrist::castle_mask(b.castle);
 
     // Undo placement
-    if (fl == KING_CASTLE || fl == QUEEN_CASTLE) {
-        remove_piece(us, KING, to);
-        add_piece(us, KING, from);
-
-        if (us == WHITE) {
-            if (fl == KING_CASTLE) {
-                remove_piece(WHITE, ROOK, F1);
-                add_piece(WHITE, ROOK, H1);
-            } else {
-                remove_piece(WHITE, ROOK, D1);
-                add_piece(WHITE, ROOK, A1);
-            }
-        } else {
-            if (fl == KING_CASTLE) {
-                remove_piece(BLACK, ROOK, F8);
-                add_piece(BLACK, ROOK, H8);
-            } else {
-                remove_piece(BLACK, ROOK, D8);
-                add_piece(BLACK, ROOK, A8);
-            }
-        }
+    if (fl == KING_CASTLE) {
+        move_piece<Us>(b, KING, to, from);
+        move_piece<Us>(b, ROOK, OO_ROOK_TO<Us>, OO_ROOK_FROM<Us>);
+    } else if (fl == QUEEN_CASTLE) {
+        move_piece<Us>(b, KING, to, from);
+        move_piece<Us>(b, ROOK, OOO_ROOK_TO<Us>, OOO_ROOK_FROM<Us>);
     } else if (is_promo_any(m)) {
         // remove promoted piece from 'to', restore pawn on 'from'
-        Piece pp;
-        switch (fl) {
-        case PROMO_N:
-        case PROMO_N_CAPTURE:
-            pp = KNIGHT;
-            break;
-        case PROMO_B:
-        case PROMO_B_CAPTURE:
-            pp = BISHOP;
-            break;
-        case PROMO_R:
-        case PROMO_R_CAPTURE:
-            pp = ROOK;
-            break;
-        default:
-            pp = QUEEN;
-            break;
-        }
-        remove_piece(us, pp, to);
-        add_piece(us, PAWN, from);
+        remove_piece<Us>(b, promo_piece_from_flag(fl), to);
+        add_piece<Us>(b, PAWN, from);
     } else {
-        remove_piece(us, u.moved_piece, to);
-        add_piece(us, u.moved_piece, from);
+        move_piece<Us>(b, u.moved_piece, to, from);
     }
 
     // Restore captured piece (if any)
     if (u.captured_piece != NO_PIECE) {
-        if (fl == EN_PASSANT) {
-            int capSq = (us == WHITE) ? (to - 8) : (to + 8);
-            add_piece((us == WHITE) ? BLACK : WHITE, PAWN, capSq);
-        } else {
-            add_piece((us == WHITE) ? BLACK : WHITE, u.captured_piece, to);
-        }
+        if (fl == EN_PASSANT)
+            add_piece<them>(b, PAWN, to - up);
+        else
+            add_piece<them>(b, u.captured_piece, to);
     }
 
     // Update Zobrist key for restored EP square (if any & capturable)
-    b.zkey_ ^= zobrist::ep_component(b, b.side_to_move);
+    b.zkey_ ^= zobrist::ep_component(b, Us);
+}
+
+void make_move(Board& b, Move m, Undo& u)
+{
+    if (b.side_to_move == WHITE)
+        make_move_for<WHITE>(b, m, u);
+    else
+        make_move_for<BLACK>(b, m, u);
+}
+
+void unmake_move(Board& b, Move m, Undo& u)
+{
+    // the side that moved is the one not to move now
+    if (b.side_to_move == BLACK)
+        unmake_move_for<WHITE>(b, m, u);
+    else
+        unmake_move_for<BLACK>(b, m, u);
 }
 
 void make_move(Board& b, Move m, Undo& u, eval::EvalState* es)
@@ -350,4 +467,10 @@ void unmake_move(Board& b, Move m, Undo& u, eval::EvalState* es)
     }
 }
 
+void copy_make(const Board& b, Board& child, Move m, Undo& u, eval::EvalState* es)
+{
+    child = b;
+    make_move(child, m, u, es);
+}
+
 } // namespace engine
@@ -3,25 +3,50 @@
 #include "eval/eval.hh"
 #include "move.hh"
 
-#include <optional>
-
 namespace engine {
 
 // Undo structure to faciliate and store information required to undo moves (for searching gametree)
 struct Undo {
-    std::optional<int> ep_prev;
-    CastlingRights castle_prev;
+    std::uint8_t ep_prev;
+    std::uint8_t castle_prev;
     int halfmove_prev;
     int fullmove_prev;
 
     Piece moved_piece{NO_PIECE};
     Piece captured_piece{NO_PIECE};
 
+    StateInfo st_prev;
+
     eval::NNUEDelta nnue{};
 };
 
 // helpers exposed so perft and movegen can share
 bool is_square_attacked(const Board& b, int sq, Colour by);
+template <Colour By> bool is_square_attacked(const Board& b, int sq);
+
+// Pieces of both colours attacking 'sq', with sliders blocked by 'occ'
+Bitboard attackers_to(const Board& b, int sq, Bitboard occ);
+
+// Every square attacked by 'by', with sliders blocked by 'occ'
+Bitboard attacked_squares(const Board& b, Colour by, Bitboard occ);
+template <Colour By> Bitboard attacked_squares(const Board& b, Bitboard occ);
+
+// Pieces of either colour that are the only piece between 'ksq' and a slider of 'by'
+Bitboard slider_blockers(const Board& b, int ksq, Colour by);
+
+// Pieces of colour c pinned to their own king by an enemy slider (from b.st)
+Bitboard pinned_pieces(const Board& b, Colour c);
+
+// Recompute b.st for the side to move; make_move and from_fen call this
+void set_check_info(Board& b);
+
+// True if the (legal) move m checks the opponent. Board-only: uses the cached
+// check squares and blockers, so nothing is made and no NNUE work is done.
+bool gives_check(const Board& b, Move m);
+
+// Zobrist key of the position after the (legal) move m, without making it,
+// so the search can prefetch the child's TT bucket ahead of make_move.
+std::uint64_t key_after(const Board& b, Move m);
 
 // mutating move application - does not check legality
 void make_move(Board& b, Move m, Undo& u);
@@ -30,4 +55,8 @@ void unmake_move(Board& b, Move m, Undo& u);
 // Overloads that also update NNUE accumulators
 void make_move(Board& b, Move m, Undo& u, eval::EvalState* es);
 void unmake_move(Board& b, Move m, Undo& u, eval::EvalState* es);
+
+// Copy-make: child = b with m applied, b is left untouched. Nothing to unmake
+// on the board; with es, eval::revert(*es, u.nnue) restores the accumulators.
+void copy_make(const Board& b, Board& child, Move m, Undo& u, eval::EvalState* es = nullptr);
 } // namespace engine
\ No newline at end of file
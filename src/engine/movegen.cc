@@ -2,368 +2,456 @@
 
 #include "attack_tables.hh"
 #include "bitboard.hh"
+#include "magic.hh"
 #include "move_do.hh"
+#include "serialize.hh"
 #include "util.hh"
 
+#include <cassert>
 #include <cstdint>
 
 namespace engine {
 
-static inline void push(std::vector<Move>& out, int f, int t, int fl = QUIET)
+static inline void push(MoveList& out, int f, int t, int fl = QUIET)
 {
-    out.push_back(make_move(f, t, fl));
+    out.push(make_move(f, t, fl));
 }
 
-static void gen_sliding(
-        std::vector<Move>& out,
-        [[maybe_unused]] const Board& b,
-        Bitboard pieces,
-        Bitboard occUs,
-        Bitboard occThem,
-        int deltas[4])
+static_assert(MoveList::SLACK >= SERIALIZE_SLACK, "MoveList must absorb the batch writers' overshoot");
+
+// every square of 'tos' as a destination from 'from'
+static inline void push_batch(MoveList& out, int from, Bitboard tos, int fl)
 {
-    while (pieces) {
-        int from = pop_lsb(pieces);
-        Bitboard ray = (1ULL << from);
-        for (int i = 0; i < 4; ++i) {
-            Bitboard step = ray;
-            while (true) {
-                switch (deltas[i]) {
-                case 1:
-                    step = east(step);
-                    break;
-                case -1:
-                    step = west(step);
-                    break;
-                case 8:
-                    step = north(step);
-                    break;
-                case -8:
-                    step = south(step);
-                    break;
-                case 9:
-                    step = ne(step);
-                    break;
-                case 7:
-                    step = nw(step);
-                    break;
-                case -7:
-                    step = se(step);
-                    break;
-                case -9:
-                    step = sw(step);
-                    break;
-                default:
-                    step = 0;
-                    break;
-                }
-                if (!step)
-                    break;
-
-                int to = __builtin_ctzll(step);
-                if (step & occUs)
-                    break;
-
-                if (step & occThem) {
-                    push(out, from, to, CAPTURE);
-                    break;
-                }
-
-                push(out, from, to, QUIET);
-            }
-        }
-    }
+    out.count += serialize(out.moves + out.count, tos, static_cast<unsigned>(make_move(from, 0, fl)), 64);
 }
 
-std::vector<Move> generate_moves(const Board& b)
+// every square of 'tos' as a pawn destination, reached from 'delta' squares behind
+static inline void push_pawn_batch(MoveList& out, Bitboard tos, int delta, int fl)
 {
-    std::vector<Move> moves;
-    const Colour us = b.side_to_move;
-    const Colour them = (us == WHITE) ? BLACK : WHITE;
+    out.count += serialize(out.moves + out.count, tos, (static_cast<unsigned>(fl) << 12) - delta, 65);
+}
 
-    const Bitboard occAll = occupancy(b);
-    const Bitboard occUs = occupancy(b, us);
-    const Bitboard occThem = occupancy(b, them);
+// quiet moves first, then captures, for one piece standing on 'from'
+static inline void push_targets(MoveList& out, int from, Bitboard targets, Bitboard occThem)
+{
+    push_batch(out, from, targets & ~occThem, QUIET);
+    push_batch(out, from, targets & occThem, CAPTURE);
+}
 
-    Bitboard pawns = b.pieces[us][PAWN];
+// N, B, R and Q promotions for every square of 'tos'
+static inline void push_promotions(MoveList& out, Bitboard tos, int delta, bool capture)
+{
+    const int base = capture ? PROMO_N_CAPTURE : PROMO_N;
+    while (tos) {
+        const int to = pop_lsb(tos);
+        serialize_promotions(out.moves + out.count, make_move(to - delta, to, base));
+        out.count += 4;
+    }
+}
 
-    if (us == WHITE) {
-        // single pushes
-        Bitboard single = north(pawns) & ~occAll;
+// Which move kinds a generator emits
+template <GenType T> inline constexpr bool EMITS_TACTICAL = T != QUIETS && T != QUIET_CHECKS; // captures, promos
+template <GenType T> inline constexpr bool EMITS_QUIET = T != CAPTURES;                       // everything else
+
+// Per-node masks shared by the piece generators
+struct GenState {
+    Bitboard occAll;
+    Bitboard occThem;
+    Bitboard target; // allowed destinations: not our own pieces, evasion mask, move kind
+    Bitboard pinned; // our pieces pinned to our king
+    int ksq;         // our king, -1 if absent (pseudo-legal generation)
+
+    // QUIET_CHECKS only
+    const Bitboard* checkSq; // squares from which each piece type attacks their king (b.st)
+    Bitboard dc;             // our pieces whose move may uncover a check on their king
+    int theirKsq;
+};
+
+// Destinations for a piece leaving 'from' after the pin and check filters
+template <GenType T> static inline Bitboard allowed_targets(const GenState& s, int from, Bitboard att, Piece p)
+{
+    if (s.pinned & (1ULL << from))
+        att &= LINE[s.ksq][from];
+    if constexpr (T == QUIET_CHECKS) {
+        // direct checks, or any square off the line to their king for a discovered check
+        if (s.dc & (1ULL << from))
+            att &= ~LINE[s.theirKsq][from] | s.checkSq[p];
+        else
+            att &= s.checkSq[p];
+    }
+    return att;
+}
 
-        Bitboard promos = single & RankBB[7];
-        Bitboard quiets = single & ~RankBB[7];
+// Pushes, double pushes, captures and promotions (no en passant) for 'pawns'.
+// Destinations are restricted to 'target'; double pushes only need the
+// intermediate square to be empty, not inside 'target'.
+template <Colour Us, GenType T>
+static void gen_pawn_moves(MoveList& out, Bitboard pawns, Bitboard occAll, Bitboard occThem, Bitboard target)
+{
+    constexpr int up = (Us == WHITE) ? 8 : -8;
+    constexpr Bitboard promoRank = (Us == WHITE) ? RankBB[7] : RankBB[0];
+    constexpr Bitboard thirdRank = (Us == WHITE) ? RankBB[2] : RankBB[5];
 
-        while (quiets) {
-            int to = pop_lsb(quiets);
-            push(moves, to - 8, to, QUIET);
-        }
-        while (promos) {
-            int to = pop_lsb(promos);
-            push(moves, to - 8, to, PROMO_N);
-            push(moves, to - 8, to, PROMO_B);
-            push(moves, to - 8, to, PROMO_R);
-            push(moves, to - 8, to, PROMO_Q);
-        }
+    // single pushes
+    Bitboard single = pawn_push<Us>(pawns) & ~occAll;
 
-        // double pushes (rank 2 -> rank 4)
-        Bitboard dbl = north(single & RankBB[2]) & ~occAll;
-        while (dbl) {
-            int to = pop_lsb(dbl);
-            push(moves, to - 16, to, DOUBLE_PUSH);
-        }
+    // double pushes (from the second rank, via an empty third rank square)
+    Bitboard dbl = pawn_push<Us>(single & thirdRank) & ~occAll & target;
+    single &= target;
 
-        // captures
-        Bitboard capL = nw(pawns) & occThem;
-        Bitboard capR = ne(pawns) & occThem;
+    if constexpr (EMITS_QUIET<T>) {
+        push_pawn_batch(out, single & ~promoRank, up, QUIET);
+        push_pawn_batch(out, dbl, 2 * up, DOUBLE_PUSH);
+    }
 
-        Bitboard capL_np = capL & ~RankBB[7];
-        Bitboard capR_np = capR & ~RankBB[7];
-        while (capL_np) {
-            int to = pop_lsb(capL_np);
-            push(moves, to - 7, to, CAPTURE);
-        }
-        while (capR_np) {
-            int to = pop_lsb(capR_np);
-            push(moves, to - 9, to, CAPTURE);
-        }
+    if constexpr (EMITS_TACTICAL<T>) {
+        push_promotions(out, single & promoRank, up, false);
 
-        Bitboard capL_pr = capL & RankBB[7];
-        Bitboard capR_pr = capR & RankBB[7];
-        while (capL_pr) {
-            int to = pop_lsb(capL_pr);
-            int from = to - 7;
-            push(moves, from, to, PROMO_N_CAPTURE);
-            push(moves, from, to, PROMO_B_CAPTURE);
-            push(moves, from, to, PROMO_R_CAPTURE);
-            push(moves, from, to, PROMO_Q_CAPTURE);
-        }
-        while (capR_pr) {
-            int to = pop_lsb(capR_pr);
-            int from = to - 9;
-            push(moves, from, to, PROMO_N_CAPTURE);
-            push(moves, from, to, PROMO_B_CAPTURE);
-            push(moves, from, to, PROMO_R_CAPTURE);
-            push(moves, from, to, PROMO_Q_CAPTURE);
-        }
+        // captures towards the a-file (from = to - (up - 1)) and the h-file (from = to - (up + 1))
+        const Bitboard capL = ((Us == WHITE) ? nw(pawns) : sw(pawns)) & occThem & target;
+        const Bitboard capR = ((Us == WHITE) ? ne(pawns) : se(pawns)) & occThem & target;
 
-        // en passant
-        if (b.ep_square) {
-            int eps = *b.ep_square;
+        push_pawn_batch(out, capL & ~promoRank, up - 1, CAPTURE);
+        push_pawn_batch(out, capR & ~promoRank, up + 1, CAPTURE);
 
-            // Ensure an enemy pawn actually double-pushed to create this ep square
-            if (eps >= 8 && (b.pieces[BLACK][PAWN] & (1ULL << (eps - 8)))) {
-                Bitboard target = 1ULL << eps;
+        push_promotions(out, capL & promoRank, up - 1, true);
+        push_promotions(out, capR & promoRank, up + 1, true);
+    }
+}
 
-                // From squares are eps-9 (NE from white pawn) and eps-7 (NW from white pawn)
-                if (ne(pawns) & target)
-                    push(moves, eps - 9, eps, EN_PASSANT);
-                if (nw(pawns) & target)
-                    push(moves, eps - 7, eps, EN_PASSANT);
-            }
-        }
-    } else // BLACK
-    {
-        // single pushes
-        Bitboard single = south(pawns) & ~occAll;
-
-        Bitboard promos = single & RankBB[0];
-        Bitboard quiets = single & ~RankBB[0];
-        while (quiets) {
-            int to = pop_lsb(quiets);
-            push(moves, to + 8, to, QUIET);
-        }
-        while (promos) {
-            int to = pop_lsb(promos);
-            int from = to + 8;
-            push(moves, from, to, PROMO_N);
-            push(moves, from, to, PROMO_B);
-            push(moves, from, to, PROMO_R);
-            push(moves, from, to, PROMO_Q);
-        }
+// Pawns that can capture en passant. With ksq >= 0 each capture is played out
+// on the occupancy and dropped if it leaves the king attacked; this covers the
+// discovered check along the rank when both pawns leave it.
+template <Colour Us> static Bitboard ep_origins(const Board& b, int ksq)
+{
+    constexpr Colour them = OPPONENT<Us>;
 
-        // double pushes (rank 7 -> rank 5)
-        Bitboard dbl = south(single & RankBB[5]) & ~occAll;
-        while (dbl) {
-            int to = pop_lsb(dbl);
-            push(moves, to + 16, to, DOUBLE_PUSH);
-        }
+    if (b.ep_square == SQ_NONE)
+        return 0ULL;
 
-        // captures
-        Bitboard capL = sw(pawns) & occThem; // to = from - 9
-        Bitboard capR = se(pawns) & occThem; // to = from - 7
+    const int eps = b.ep_square;
+    const int capSq = (Us == WHITE) ? (eps - 8) : (eps + 8);
 
-        Bitboard capL_np = capL & ~RankBB[0];
-        Bitboard capR_np = capR & ~RankBB[0];
-        while (capL_np) {
-            int to = pop_lsb(capL_np);
-            push(moves, to + 9, to, CAPTURE);
-        }
-        while (capR_np) {
-            int to = pop_lsb(capR_np);
-            push(moves, to + 7, to, CAPTURE);
-        }
+    // Ensure an enemy pawn actually double-pushed to create this ep square
+    if (capSq < 0 || capSq > 63 || !(b.pieces[them][PAWN] & (1ULL << capSq)))
+        return 0ULL;
 
-        Bitboard capL_pr = capL & RankBB[0];
-        Bitboard capR_pr = capR & RankBB[0];
-        while (capL_pr) {
-            int to = pop_lsb(capL_pr);
-            int from = to + 9;
-            push(moves, from, to, PROMO_N_CAPTURE);
-            push(moves, from, to, PROMO_B_CAPTURE);
-            push(moves, from, to, PROMO_R_CAPTURE);
-            push(moves, from, to, PROMO_Q_CAPTURE);
-        }
-        while (capR_pr) {
-            int to = pop_lsb(capR_pr);
-            int from = to + 7;
-            push(moves, from, to, PROMO_N_CAPTURE);
-            push(moves, from, to, PROMO_B_CAPTURE);
-            push(moves, from, to, PROMO_R_CAPTURE);
-            push(moves, from, to, PROMO_Q_CAPTURE);
-        }
+    // our pawns that attack the ep square
+    Bitboard from = PAWN_ATTACKS[them][eps] & b.pieces[Us][PAWN];
+    if (ksq < 0)
+        return from;
 
-        if (b.ep_square) {
-            int eps = *b.ep_square;
+    Bitboard legal = 0ULL;
+    while (from) {
+        const int f = pop_lsb(from);
+        const Bitboard occ = (occupancy(b) ^ (1ULL << f) ^ (1ULL << capSq)) | (1ULL << eps);
+        if (!(attackers_to(b, ksq, occ) & occupancy(b, them) & ~(1ULL << capSq)))
+            legal |= 1ULL << f;
+    }
+    return legal;
+}
 
-            // Ensure an enemy pawn actually double-pushed to create this ep square
-            if (eps <= 55 && (b.pieces[WHITE][PAWN] & (1ULL << (eps + 8)))) {
-                Bitboard target = 1ULL << eps;
+template <Colour Us> static void gen_en_passant(MoveList& out, const Board& b, int ksq)
+{
+    Bitboard from = ep_origins<Us>(b, ksq);
+    while (from)
+        push(out, pop_lsb(from), b.ep_square, EN_PASSANT);
+}
 
-                // From squares are eps+7 (SE from black pawn) and eps+9 (SW from black pawn)
-                if (se(pawns) & target)
-                    push(moves, eps + 7, eps, EN_PASSANT);
-                if (sw(pawns) & target)
-                    push(moves, eps + 9, eps, EN_PASSANT);
-            }
-        }
+template <Piece P> static inline Bitboard piece_attacks(int sq, Bitboard occ)
+{
+    if constexpr (P == KNIGHT)
+        return KNIGHT_ATTACKS[sq];
+    else if constexpr (P == BISHOP)
+        return bishop_attacks(sq, occ);
+    else if constexpr (P == ROOK)
+        return rook_attacks(sq, occ);
+    else
+        return queen_attacks(sq, occ);
+}
+
+// Knights and sliders
+template <GenType T, Piece P> static void gen_piece_moves(MoveList& out, const GenState& s, Bitboard pieces)
+{
+    while (pieces) {
+        const int from = pop_lsb(pieces);
+        push_targets(out, from, allowed_targets<T>(s, from, piece_attacks<P>(from, s.occAll) & s.target, P), s.occThem);
     }
+}
 
-    // Knights
-    Bitboard knights = b.pieces[us][KNIGHT];
-    while (knights) {
-        int from = pop_lsb(knights);
-        Bitboard att = KNIGHT_ATTACKS[from] & ~occUs;
-        Bitboard caps = att & occThem;
-        Bitboard quiet = att & ~occThem;
-        while (quiet) {
-            int to = pop_lsb(quiet);
-            push(moves, from, to, QUIET);
-        }
-        while (caps) {
-            int to = pop_lsb(caps);
-            push(moves, from, to, CAPTURE);
+// Castling to one side is open: rights, king and rook at home, path empty and
+// none of the king's squares (start, transit, destination) attacked according
+// to 'attacked'.
+template <Colour Us, bool KingSide, typename Attacked>
+static bool castling_open(const Board& b, Bitboard occAll, Attacked attacked)
+{
+    constexpr int ksq = (Us == WHITE) ? E1 : E8;
+    constexpr int dir = KingSide ? 1 : -1;
+    constexpr int rsq = KingSide ? ksq + 3 : ksq - 4;
+    constexpr Bitboard path = KingSide ? ((1ULL << (ksq + 1)) | (1ULL << (ksq + 2)))
+                                       : ((1ULL << (ksq - 1)) | (1ULL << (ksq - 2)) | (1ULL << (ksq - 3)));
+    constexpr CastlingRight cr = (Us == WHITE) ? (KingSide ? WHITE_OO : WHITE_OOO) : (KingSide ? BLACK_OO : BLACK_OOO);
+
+    return can_castle(b, cr) && (b.pieces[Us][KING] & (1ULL << ksq)) && (b.pieces[Us][ROOK] & (1ULL << rsq)) &&
+           !(occAll & path) && !attacked(ksq) && !attacked(ksq + dir) && !attacked(ksq + 2 * dir);
+}
+
+// Castling moves open according to 'attacked'. With checksOnly only castling
+// moves that give check are emitted.
+template <Colour Us, typename Attacked>
+static void gen_castling(MoveList& out, const Board& b, Bitboard occAll, Attacked attacked, bool checksOnly = false)
+{
+    constexpr int ksq = (Us == WHITE) ? E1 : E8;
+
+    if (castling_open<Us, true>(b, occAll, attacked) &&
+        (!checksOnly || gives_check(b, make_move(ksq, ksq + 2, KING_CASTLE))))
+        push(out, ksq, ksq + 2, KING_CASTLE);
+    if (castling_open<Us, false>(b, occAll, attacked) &&
+        (!checksOnly || gives_check(b, make_move(ksq, ksq - 2, QUEEN_CASTLE))))
+        push(out, ksq, ksq - 2, QUEEN_CASTLE);
+}
+
+template <Colour Us> static void generate_pseudo(const Board& b, MoveList& moves)
+{
+    constexpr Colour us = Us;
+    constexpr Colour them = OPPONENT<Us>;
+
+    GenState s{};
+    s.occAll = occupancy(b);
+    s.occThem = occupancy(b, them);
+    s.target = ~occupancy(b, us);
+    s.ksq = -1;
+
+    gen_pawn_moves<Us, LEGAL>(moves, b.pieces[us][PAWN], s.occAll, s.occThem, ~0ULL);
+    gen_en_passant<Us>(moves, b, -1);
+
+    gen_piece_moves<LEGAL, KNIGHT>(moves, s, b.pieces[us][KNIGHT]);
+    gen_piece_moves<LEGAL, BISHOP>(moves, s, b.pieces[us][BISHOP]);
+    gen_piece_moves<LEGAL, ROOK>(moves, s, b.pieces[us][ROOK]);
+    gen_piece_moves<LEGAL, QUEEN>(moves, s, b.pieces[us][QUEEN]);
+
+    // King (+ castling, pseudo-legal)
+    Bitboard king = b.pieces[us][KING];
+    if (king) {
+        int from = __builtin_ctzll(king);
+        push_targets(moves, from, KING_ATTACKS[from] & s.target, s.occThem);
+        // one attack map for all castling squares instead of a probe per square
+        if (b.castle & ((Us == WHITE) ? (WHITE_OO | WHITE_OOO) : (BLACK_OO | BLACK_OOO))) {
+            const Bitboard danger = attacked_squares<them>(b, s.occAll);
+            gen_castling<Us>(moves, b, s.occAll, [&](int sq) { return (danger & (1ULL << sq)) != 0; });
         }
     }
+}
 
-    // Bishops
-    {
-        int deltas[4] = {9, 7, -7, -9};
-        gen_sliding(moves, b, b.pieces[us][BISHOP], occUs, occThem, deltas);
-    }
+void generate_moves(const Board& b, MoveList& moves)
+{
+    if (b.side_to_move == WHITE)
+        generate_pseudo<WHITE>(b, moves);
+    else
+        generate_pseudo<BLACK>(b, moves);
+}
 
-    // Rooks
-    {
-        int deltas[4] = {1, -1, 8, -8};
-        gen_sliding(moves, b, b.pieces[us][ROOK], occUs, occThem, deltas);
-    }
+// Legal generator. Checkers, pinned pieces and the squares the enemy attacks
+// (seen through our king) are computed once; every piece is then restricted
+// to moves that keep the king safe, so no move is played out.
+template <Colour Us, GenType T> static void generate_for(const Board& b, MoveList& moves)
+{
+    constexpr Colour us = Us;
+    constexpr Colour them = OPPONENT<Us>;
+    const Bitboard occUs = occupancy(b, us);
 
-    // Queens
-    {
-        int deltas8[4] = {1, -1, 8, -8};
-        int deltasD[4] = {9, 7, -7, -9};
-        gen_sliding(moves, b, b.pieces[us][QUEEN], occUs, occThem, deltas8);
-        gen_sliding(moves, b, b.pieces[us][QUEEN], occUs, occThem, deltasD);
+    GenState s{};
+    s.occAll = occupancy(b);
+    s.occThem = occupancy(b, them);
+    s.ksq = king_sq(b, us);
+
+    if constexpr (T == QUIET_CHECKS) {
+        s.theirKsq = king_sq(b, them);
+        if (s.theirKsq < 0)
+            return;
+        s.checkSq = b.st.check_squares;
+        s.dc = b.st.blockers[them] & occUs;
     }
 
-    // King (+ castling, pseudo-legal)
-    {
-        Bitboard king = b.pieces[us][KING];
-        if (king) {
-            int from = __builtin_ctzll(king);
-            Bitboard kMoves =
-                    (north(king) | south(king) | east(king) | west(king) | ne(king) | nw(king) | se(king) | sw(king)) &
-                    ~occUs;
-
-            Bitboard caps = kMoves & occThem;
-            Bitboard quiet = kMoves & ~occThem;
-            while (quiet) {
-                int to = pop_lsb(quiet);
-                push(moves, from, to, QUIET);
-            }
-            while (caps) {
-                int to = pop_lsb(caps);
-                push(moves, from, to, CAPTURE);
-            }
-
-            // Castling (still pseudo-legal here; legality filter will remove if king in check after)
-            if (us == WHITE) {
-                const bool kingOnE1 = (b.pieces[WHITE][KING] & (1ULL << E1)) != 0;
-                if (b.castle.wk && kingOnE1) {
-                    bool rookOnH1 = (b.pieces[WHITE][ROOK] & (1ULL << H1)) != 0;
-                    bool pathEmpty = (occAll & ((1ULL << F1) | (1ULL << G1))) == 0;
-                    bool safe = !is_square_attacked(b, E1, them) && !is_square_attacked(b, F1, them) &&
-                                !is_square_attacked(b, G1, them);
-                    if (rookOnH1 && pathEmpty && safe)
-                        push(moves, E1, G1, KING_CASTLE);
-                }
-                if (b.castle.wq && kingOnE1) {
-                    bool rookOnA1 = (b.pieces[WHITE][ROOK] & (1ULL << A1)) != 0;
-                    bool pathEmpty = (occAll & ((1ULL << B1) | (1ULL << C1) | (1ULL << D1))) == 0;
-                    bool safe = !is_square_attacked(b, E1, them) && !is_square_attacked(b, D1, them) &&
-                                !is_square_attacked(b, C1, them);
-                    if (rookOnA1 && pathEmpty && safe)
-                        push(moves, E1, C1, QUEEN_CASTLE);
-                }
-            } else {
-                const bool kingOnE8 = (b.pieces[BLACK][KING] & (1ULL << E8)) != 0;
-                if (b.castle.bk && kingOnE8) {
-                    bool rookOnH8 = (b.pieces[BLACK][ROOK] & (1ULL << H8)) != 0;
-                    bool pathEmpty = (occAll & ((1ULL << F8) | (1ULL << G8))) == 0;
-                    bool safe = !is_square_attacked(b, E8, them) && !is_square_attacked(b, F8, them) &&
-                                !is_square_attacked(b, G8, them);
-                    if (rookOnH8 && pathEmpty && safe)
-                        push(moves, E8, G8, KING_CASTLE);
-                }
-                if (b.castle.bq && kingOnE8) {
-                    bool rookOnA8 = (b.pieces[BLACK][ROOK] & (1ULL << A8)) != 0;
-                    bool pathEmpty = (occAll & ((1ULL << D8) | (1ULL << C8) | (1ULL << B8))) == 0;
-                    bool safe = !is_square_attacked(b, E8, them) && !is_square_attacked(b, D8, them) &&
-                                !is_square_attacked(b, C8, them);
-                    if (rookOnA8 && pathEmpty && safe)
-                        push(moves, E8, C8, QUEEN_CASTLE);
-                }
-            }
+    // move kinds: captures land on enemy pieces, quiet moves on empty squares
+    Bitboard kinds = ~occUs;
+    if constexpr (!EMITS_QUIET<T>)
+        kinds = s.occThem;
+    else if constexpr (!EMITS_TACTICAL<T>)
+        kinds = ~s.occAll;
+
+    const Bitboard checkers = b.st.checkers;
+    if (s.ksq >= 0) {
+        const Bitboard king = 1ULL << s.ksq;
+        assert(T != EVASIONS || checkers);
+
+        // remove our king so sliders x-ray through it: stepping back along a
+        // checking ray is not an escape
+        const Bitboard danger = attacked_squares<them>(b, s.occAll ^ king);
+        Bitboard kTargets = KING_ATTACKS[s.ksq] & kinds & ~danger;
+        if constexpr (T == QUIET_CHECKS)
+            kTargets = (s.dc & king) ? (kTargets & ~LINE[s.theirKsq][s.ksq]) : 0ULL;
+        push_targets(moves, s.ksq, kTargets, s.occThem);
+
+        // double check: only the king may move
+        if (checkers & (checkers - 1))
+            return;
+
+        if constexpr (EMITS_QUIET<T>) {
+            if (!checkers)
+                gen_castling<Us>(
+                        moves,
+                        b,
+                        s.occAll,
+                        [&](int sq) { return (danger & (1ULL << sq)) != 0; },
+                        T == QUIET_CHECKS);
         }
+
+        s.pinned = b.st.blockers[us] & occUs;
     }
 
-    return moves;
+    // single check: capture the checker or block the ray
+    Bitboard evasion = ~0ULL;
+    if (checkers)
+        evasion = checkers | BETWEEN[s.ksq][__builtin_ctzll(checkers)];
+    s.target = kinds & evasion;
+
+    // pawns: unpinned ones in bulk, pinned ones (and discovered-check
+    // candidates) one at a time with their own destination mask
+    const Bitboard pawns = b.pieces[us][PAWN];
+    Bitboard single = pawns & (s.pinned | s.dc);
+    Bitboard pushTarget = evasion;
+    if constexpr (T == QUIET_CHECKS)
+        pushTarget &= s.checkSq[PAWN];
+    gen_pawn_moves<Us, T>(moves, pawns & ~single, s.occAll, s.occThem, pushTarget);
+    while (single) {
+        const int from = pop_lsb(single);
+        gen_pawn_moves<Us, T>(moves, 1ULL << from, s.occAll, s.occThem, allowed_targets<T>(s, from, evasion, PAWN));
+    }
+    if constexpr (EMITS_TACTICAL<T>)
+        gen_en_passant<Us>(moves, b, s.ksq);
+
+    // a pinned knight can never move
+    gen_piece_moves<T, KNIGHT>(moves, s, b.pieces[us][KNIGHT] & ~s.pinned);
+    gen_piece_moves<T, BISHOP>(moves, s, b.pieces[us][BISHOP]);
+    gen_piece_moves<T, ROOK>(moves, s, b.pieces[us][ROOK]);
+    gen_piece_moves<T, QUEEN>(moves, s, b.pieces[us][QUEEN]);
 }
 
-// uses pseudo-move generator to generate all possible moves.
-// moves are legal if they dont result in the player moving to be
-// placed in check.
-std::vector<Move> generate_legal_moves(Board& b)
+// Pawn moves for 'pawns' as gen_pawn_moves<Us, LEGAL> would emit them, each
+// promotion counting four.
+template <Colour Us> static int count_pawn_moves(Bitboard pawns, Bitboard occAll, Bitboard occThem, Bitboard target)
 {
-    std::vector<Move> legal;
-    std::vector<Move> pseudo = generate_moves(b);
+    constexpr Bitboard promoRank = (Us == WHITE) ? RankBB[7] : RankBB[0];
+    constexpr Bitboard thirdRank = (Us == WHITE) ? RankBB[2] : RankBB[5];
+
+    const Bitboard single = pawn_push<Us>(pawns) & ~occAll;
+    const Bitboard dbl = pawn_push<Us>(single & thirdRank) & ~occAll & target;
+    const Bitboard caps = occThem & target;
+    const Bitboard capL = ((Us == WHITE) ? nw(pawns) : sw(pawns)) & caps;
+    const Bitboard capR = ((Us == WHITE) ? ne(pawns) : se(pawns)) & caps;
+    const Bitboard tos = single & target;
+
+    return __builtin_popcountll(tos & ~promoRank) + __builtin_popcountll(dbl) +
+           __builtin_popcountll(capL & ~promoRank) + __builtin_popcountll(capR & ~promoRank) +
+           4 * (__builtin_popcountll(tos & promoRank) + __builtin_popcountll(capL & promoRank) +
+                __builtin_popcountll(capR & promoRank));
+}
 
-    const Colour us = b.side_to_move;
-    const Colour them = (us == WHITE) ? BLACK : WHITE;
+// generate_for<Us, LEGAL> with every destination set popcounted instead of
+// serialised
+template <Colour Us> static int count_for(const Board& b)
+{
+    constexpr Colour us = Us;
+    constexpr Colour them = OPPONENT<Us>;
+    const Bitboard occUs = occupancy(b, us);
+    const Bitboard occAll = occupancy(b);
+    const Bitboard occThem = occupancy(b, them);
+    const int ksq = king_sq(b, us);
 
-    for (Move m : pseudo) {
-        Undo u;
-        make_move(b, m, u);
+    int n = 0;
+    Bitboard pinned = 0ULL;
+    const Bitboard checkers = b.st.checkers;
+    if (ksq >= 0) {
+        const Bitboard danger = attacked_squares<them>(b, occAll ^ (1ULL << ksq));
+        n += __builtin_popcountll(KING_ATTACKS[ksq] & ~occUs & ~danger);
 
-        int ksq = king_sq(b, us);
-        bool checked = (ksq >= 0) && is_square_attacked(b, ksq, them);
+        if (checkers & (checkers - 1))
+            return n;
 
-        unmake_move(b, m, u);
+        if (!checkers) {
+            const auto attacked = [&](int sq) { return (danger & (1ULL << sq)) != 0; };
+            n += castling_open<Us, true>(b, occAll, attacked) + castling_open<Us, false>(b, occAll, attacked);
+        }
 
-        if (!checked)
-            legal.push_back(m);
+        pinned = b.st.blockers[us] & occUs;
     }
 
-    return legal;
+    Bitboard evasion = ~0ULL;
+    if (checkers)
+        evasion = checkers | BETWEEN[ksq][__builtin_ctzll(checkers)];
+    const Bitboard target = ~occUs & evasion;
+
+    const Bitboard pawns = b.pieces[us][PAWN];
+    n += count_pawn_moves<Us>(pawns & ~pinned, occAll, occThem, evasion);
+    for (Bitboard pp = pawns & pinned; pp;) {
+        const int from = pop_lsb(pp);
+        n += count_pawn_moves<Us>(1ULL << from, occAll, occThem, evasion & LINE[ksq][from]);
+    }
+    n += __builtin_popcountll(ep_origins<Us>(b, ksq));
+
+    for (Bitboard pcs = b.pieces[us][KNIGHT] & ~pinned; pcs;)
+        n += __builtin_popcountll(KNIGHT_ATTACKS[pop_lsb(pcs)] & target);
+
+    const auto sliders = [&](Bitboard pcs, auto attacks) {
+        while (pcs) {
+            const int from = pop_lsb(pcs);
+            Bitboard att = attacks(from, occAll) & target;
+            if (pinned & (1ULL << from))
+                att &= LINE[ksq][from];
+            n += __builtin_popcountll(att);
+        }
+    };
+    sliders(b.pieces[us][BISHOP] | b.pieces[us][QUEEN], [](int sq, Bitboard occ) { return bishop_attacks(sq, occ); });
+    sliders(b.pieces[us][ROOK] | b.pieces[us][QUEEN], [](int sq, Bitboard occ) { return rook_attacks(sq, occ); });
+    return n;
+}
+
+int count_legal_moves(const Board& b)
+{
+    return (b.side_to_move == WHITE) ? count_for<WHITE>(b) : count_for<BLACK>(b);
+}
+
+template <GenType T> void generate(const Board& b, MoveList& moves)
+{
+    if (b.side_to_move == WHITE)
+        generate_for<WHITE, T>(b, moves);
+    else
+        generate_for<BLACK, T>(b, moves);
+}
+
+template void generate<CAPTURES>(const Board&, MoveList&);
+template void generate<QUIETS>(const Board&, MoveList&);
+template void generate<EVASIONS>(const Board&, MoveList&);
+template void generate<QUIET_CHECKS>(const Board&, MoveList&);
+template void generate<LEGAL>(const Board&, MoveList&);
+
+void generate_legal_moves(const Board& b, MoveList& moves)
+{
+    generate<LEGAL>(b, moves);
+}
+
+std::vector<Move> generate_moves(const Board& b)
+{
+    MoveList list;
+    generate_moves(b, list);
+    return std::vector<Move>(list.begin(), list.end());
+}
+
+std::vector<Move> generate_legal_moves(const Board& b)
+{
+    MoveList list;
+    generate_legal_moves(b, list);
+    return std::vector<Move>(list.begin(), list.end());
 }
 } // namespace engine
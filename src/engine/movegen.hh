@@ -5,9 +5,81 @@
 #include <vector>
 
 namespace engine {
-// pseudo-legal generator (fast, may include moves leaving king in check)
-std::vector<Move> generate_moves(const Board&);
 
-// legal generator (filters out illegal moves by make/unmake + check test)
-std::vector<Move> generate_legal_moves(Board&);
+// Fixed-capacity move buffer, filled in place by the generators so the
+// movegen path never touches the heap. No legal position has more than
+// 218 moves, so 256 leaves headroom for pseudo-legal lists as well.
+// The batch writers in serialize.hh store whole vectors past 'count', so the
+// buffer carries SLACK spare entries behind CAPACITY.
+struct MoveList {
+    static constexpr int CAPACITY = 256;
+    static constexpr int SLACK = 32;
+
+    Move moves[CAPACITY + SLACK];
+    int count = 0;
+
+    void push(Move m)
+    {
+        moves[count++] = m;
+    }
+    void clear()
+    {
+        count = 0;
+    }
+    int size() const
+    {
+        return count;
+    }
+    bool empty() const
+    {
+        return count == 0;
+    }
+    Move operator[](int i) const
+    {
+        return moves[i];
+    }
+    Move* begin()
+    {
+        return moves;
+    }
+    Move* end()
+    {
+        return moves + count;
+    }
+    const Move* begin() const
+    {
+        return moves;
+    }
+    const Move* end() const
+    {
+        return moves + count;
+    }
+};
+
+// Move kinds for generate<T>. All of them produce legal moves only.
+//   CAPTURES      captures, en passant and every promotion
+//   QUIETS        all remaining moves (pushes, piece moves, castling)
+//   EVASIONS      every legal move; only valid while in check
+//   QUIET_CHECKS  non-capturing, non-promoting moves that give check
+//   LEGAL         every legal move
+enum GenType { CAPTURES, QUIETS, EVASIONS, QUIET_CHECKS, LEGAL };
+
+// Appends legal moves of kind T to 'out'.
+template <GenType T> void generate(const Board&, MoveList& out);
+
+// pseudo-legal generator (fast, may include moves leaving king in check).
+// Appends to 'out'.
+void generate_moves(const Board&, MoveList& out);
+
+// legal generator (pin/check masks, no make/unmake), same as generate<LEGAL>.
+// Appends to 'out'.
+void generate_legal_moves(const Board&, MoveList& out);
+
+// Number of legal moves, same as generate<LEGAL>(b, list).size() but counted
+// from the destination sets without building a list.
+int count_legal_moves(const Board&);
+
+// Compatibility wrappers returning a fresh vector (tests and tools)
+std::vector<Move> generate_moves(const Board&);
+std::vector<Move> generate_legal_moves(const Board&);
 } // namespace engine
@@ -3,22 +3,27 @@
 #include "move_do.hh"
 #include "movegen.hh"
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 namespace engine {
 //  follows chess programming wiki for performance test (perft) function.
 // https://www.chessprogramming.org/Perft
-// possible furture speed up: hashing game states -> number of positions.
-// possible because can reach same game state from differing orders of moves.
+// the hashed variant below caches subtree counts, since the same state is
+// reached by differing orders of moves.
 std::uint64_t perft(Board& b, int depth)
 {
     if (depth == 0)
         return 1;
 
-    auto moves = generate_legal_moves(b);
-
-    // can return early here as we know the number of legal moves
-    // the number of legal moves with depth 1 is the number of states.
+    // the number of legal moves with depth 1 is the number of states;
+    // counted straight from the target sets, no list is built
     if (depth == 1)
-        return moves.size();
+        return static_cast<std::uint64_t>(count_legal_moves(b));
+
+    MoveList moves;
+    generate_legal_moves(b, moves);
 
     std::uint64_t nodes = 0;
 
@@ -31,12 +36,78 @@ std::uint64_t perft(Board& b, int depth)
     return nodes;
 }
 
+PerftTable::PerftTable(std::size_t megabytes)
+{
+    std::size_t n = 1;
+    while (2 * n * sizeof(Entry) <= megabytes * 1024 * 1024)
+        n *= 2;
+    entries_ = std::make_unique<Entry[]>(n);
+    mask_ = n - 1;
+}
+
+static constexpr int PERFT_DEPTH_SHIFT = 56;
+static constexpr std::uint64_t PERFT_NODES_MASK = (1ULL << PERFT_DEPTH_SHIFT) - 1;
+
+bool PerftTable::probe(std::uint64_t key, int depth, std::uint64_t& nodes) const
+{
+    const Entry& e = entries_[key & mask_];
+    const std::uint64_t data = e.data.load(std::memory_order_relaxed);
+    const std::uint64_t check = e.check.load(std::memory_order_relaxed);
+    if ((check ^ data) != key || static_cast<int>(data >> PERFT_DEPTH_SHIFT) != depth)
+        return false;
+    nodes = data & PERFT_NODES_MASK;
+    return true;
+}
+
+void PerftTable::store(std::uint64_t key, int depth, std::uint64_t nodes)
+{
+    Entry& e = entries_[key & mask_];
+    const std::uint64_t data = (static_cast<std::uint64_t>(depth) << PERFT_DEPTH_SHIFT) | nodes;
+    e.check.store(key ^ data, std::memory_order_relaxed);
+    e.data.store(data, std::memory_order_relaxed);
+}
+
+void PerftTable::clear()
+{
+    for (std::uint64_t i = 0; i <= mask_; ++i) {
+        entries_[i].check.store(0, std::memory_order_relaxed);
+        entries_[i].data.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::uint64_t perft(Board& b, int depth, PerftTable& tt)
+{
+    if (depth == 0)
+        return 1;
+
+    // depth 1 is a move count, cheaper than a probe
+    if (depth == 1)
+        return static_cast<std::uint64_t>(count_legal_moves(b));
+
+    std::uint64_t nodes = 0;
+    if (tt.probe(b.zkey(), depth, nodes))
+        return nodes;
+
+    MoveList moves;
+    generate_legal_moves(b, moves);
+
+    for (auto m : moves) {
+        Undo u;
+        make_move(b, m, u);
+        nodes += perft(b, depth - 1, tt);
+        unmake_move(b, m, u);
+    }
+    tt.store(b.zkey(), depth, nodes);
+    return nodes;
+}
+
 // perft divide lists all moves and perft of the decremented depth.
 // returns a vector of pairs Moves/number of nodes.
 std::vector<std::pair<Move, std::uint64_t>> perft_divide(Board& b, int depth)
 {
     std::vector<std::pair<Move, std::uint64_t>> out;
-    auto moves = generate_legal_moves(b);
+    MoveList moves;
+    generate_legal_moves(b, moves);
 
     for (auto m : moves) {
         Undo u;
@@ -48,4 +119,80 @@ std::vector<std::pair<Move, std::uint64_t>> perft_divide(Board& b, int depth)
 
     return out;
 }
+
+// One unit of parallel work: the subtree after root move 'root' and reply 'reply'
+struct PerftTask {
+    int rootIndex;
+    Move root;
+    Move reply;
+};
+
+std::vector<std::pair<Move, std::uint64_t>> perft_divide(const Board& b, int depth, int threads, PerftTable* tt)
+{
+    if (threads <= 0)
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    // shallow trees are not worth a thread
+    if (depth < 3 || (threads == 1 && !tt)) {
+        Board copy = b;
+        return perft_divide(copy, depth);
+    }
+
+    MoveList rootMoves;
+    generate_legal_moves(b, rootMoves);
+
+    // split below every root move so a few wide root moves cannot leave
+    // most workers idle
+    std::vector<PerftTask> tasks;
+    for (int i = 0; i < rootMoves.size(); ++i) {
+        Board child = b;
+        Undo u;
+        make_move(child, rootMoves[i], u);
+
+        MoveList replies;
+        generate_legal_moves(child, replies);
+        for (Move r : replies)
+            tasks.push_back({i, rootMoves[i], r});
+    }
+
+    std::vector<std::uint64_t> nodes(tasks.size());
+    std::atomic<std::size_t> next{0};
+    auto worker = [&] {
+        for (std::size_t t; (t = next.fetch_add(1, std::memory_order_relaxed)) < tasks.size();) {
+            Board local = b;
+            Undo u1, u2;
+            make_move(local, tasks[t].root, u1);
+            make_move(local, tasks[t].reply, u2);
+            nodes[t] = tt ? perft(local, depth - 2, *tt) : perft(local, depth - 2);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    const int helpers = std::min<int>(threads, static_cast<int>(tasks.size())) - 1;
+    for (int i = 0; i < helpers; ++i)
+        pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool)
+        th.join();
+
+    std::vector<std::pair<Move, std::uint64_t>> out;
+    for (Move m : rootMoves)
+        out.emplace_back(m, 0);
+    for (std::size_t t = 0; t < tasks.size(); ++t)
+        out[tasks[t].rootIndex].second += nodes[t];
+    return out;
+}
+
+std::uint64_t perft(const Board& b, int depth, int threads, PerftTable* tt)
+{
+    if (depth < 3) {
+        Board copy = b;
+        return tt ? perft(copy, depth, *tt) : perft(copy, depth);
+    }
+
+    std::uint64_t total = 0;
+    for (const auto& kv : perft_divide(b, depth, threads, tt))
+        total += kv.second;
+    return total;
+}
 } // namespace engine
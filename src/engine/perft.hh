@@ -2,12 +2,49 @@
 #include "board.hh"
 #include "move.hh"
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <utility>
 #include <vector>
 
 namespace engine {
+
+// Perft transposition cache: subtree counts keyed by zkey() and depth.
+// Lock-free, so parallel perft workers share one table: each entry stores
+// key ^ data next to data, and a torn or foreign entry fails the check on
+// probe instead of returning a wrong count. Always-replace, one entry per slot.
+struct PerftTable {
+    // size rounded down to a power-of-two number of entries (at least one)
+    explicit PerftTable(std::size_t megabytes);
+
+    bool probe(std::uint64_t key, int depth, std::uint64_t& nodes) const;
+    void store(std::uint64_t key, int depth, std::uint64_t nodes);
+    void clear();
+
+  private:
+    struct Entry {
+        std::atomic<std::uint64_t> check{0}; // key ^ data
+        std::atomic<std::uint64_t> data{0};  // depth in the top 8 bits, nodes below
+    };
+    std::unique_ptr<Entry[]> entries_;
+    std::uint64_t mask_;
+};
+
 std::uint64_t perft(Board& b, int depth);
 
+// Hashed perft: subtrees already counted in 'tt' are not walked again
+std::uint64_t perft(Board& b, int depth, PerftTable& tt);
+
 std::vector<std::pair<Move, std::uint64_t>> perft_divide(Board& b, int depth);
+
+// Parallel perft: the depth-2 subtrees are shared out among 'threads' workers,
+// each playing them on its own copy of b. Counts are identical to the serial
+// versions. threads <= 0 uses every hardware thread. With tt the workers share
+// one hash table.
+std::uint64_t perft(const Board& b, int depth, int threads, PerftTable* tt = nullptr);
+
+std::vector<std::pair<Move, std::uint64_t>>
+perft_divide(const Board& b, int depth, int threads, PerftTable* tt = nullptr);
 } // namespace engine
@@ -10,36 +10,109 @@
 #include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <limits>
+#include <new>
 #include <string>
+#include <thread>
 #include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace engine {
 
-// transposition table
-enum : uint8_t { TT_EMPTY = 0, TT_EXACT = 1, TT_LOWER = 2, TT_UPPER = 3 };
+// transposition table, shared by all search threads.
+//
+// Cache-line buckets of four lock-free entries. Each entry is two 64-bit
+// atomics: the packed fields in 'data' and the full key stored as key ^ data.
+// A slot torn by two threads writing at once fails the key test and reads as
+// a miss, so threads share the table without locks (as PerftTable does).
+// TT_NONE entries carry only a static eval (stored by qsearch).
+enum : uint8_t { TT_NONE = 0, TT_EXACT = 1, TT_LOWER = 2, TT_UPPER = 3 };
+
+// Decoded entry, packed into TTSlot::data by tt_pack
 struct TTEntry {
-    std::uint64_t key = 0;   // zobrist key -- 8 bytes
-    Move best = 0;           // best/PV move (if known) -- 2 bytes
-    int score = 0;           // stored score in cp -- 4 bytes
-    int16_t depth = -1;      // search depth remaining when stored -- 2 bytes
-    uint8_t flag = TT_EMPTY; // EXACT/LOWER/UPPER -- 1 byte
-    uint8_t _pad = 0;        // padding -- 1 byte
-    // 18 bytes total + padding
+    Move best;             // best/PV move (if known)
+    std::int16_t score;    // stored score in cp
+    std::int16_t eval;     // static eval, EVAL_NONE if not known
+    std::uint8_t depth8;   // depth remaining + TT_DEPTH_OFFSET, 0 = empty slot
+    std::uint8_t genBound; // search generation (top 6 bits) | bound (low 2 bits)
+};
+
+struct TTSlot {
+    std::atomic<std::uint64_t> check{0}; // key ^ data
+    std::atomic<std::uint64_t> data{0};  // packed TTEntry
 };
 
-static constexpr std::size_t TT_LOG2 = 22;
-static constexpr std::size_t TT_SIZE = (1ULL << TT_LOG2);
-static constexpr std::uint64_t TT_MASK = TT_SIZE - 1;
-static TTEntry g_tt[TT_SIZE]; // fixed size for simplicity
+static constexpr int TT_BUCKET_ENTRIES = 4;
+struct alignas(64) TTBucket {
+    TTSlot entry[TT_BUCKET_ENTRIES];
+};
+static_assert(sizeof(TTBucket) == 64, "one bucket per cache line");
+
+static constexpr int TT_DEPTH_OFFSET = 2; // DEPTH_QS is stored as 1 so 0 can mean 'empty'
+static constexpr int DEPTH_QS = -1;       // depth of eval-only entries from qsearch
+static constexpr int EVAL_NONE = -32768;
+static constexpr std::uint8_t TT_BOUND_MASK = 0x3;
+static constexpr std::uint8_t TT_GEN_DELTA = 0x4; // the generation counts above the bound bits
+static constexpr std::size_t TT_DEFAULT_MB = 64;
+
+// TT memory, allocated on first search or setoption Hash: explicit huge pages
+// if the system has them reserved, else 2 MB aligned memory advised for
+// transparent huge pages, else ordinary pages. A 64 MB table spans 32 huge
+// pages instead of 16384 small ones, so probes stop missing the TLB.
+// With a SharedHash name the table is a named POSIX shared-memory segment
+// instead, mapped by every engine process on the host that uses the name.
+enum class TTMemory { NONE, HUGETLB, THP, HEAP, SHARED };
+static TTBucket* g_tt = nullptr;
+static std::size_t g_tt_bytes = 0;
+static TTMemory g_tt_memory = TTMemory::NONE;
+static std::uint64_t g_tt_mask = 0;
+static std::size_t g_tt_mb = TT_DEFAULT_MB;
+static std::uint8_t g_tt_gen = 0; // bumped once per search (per process, also for a shared table)
+static std::string g_tt_shm;      // shared-memory segment name, empty = private table
 
 // time management statics
 using clock = std::chrono::steady_clock;
 static clock::time_point g_start;
 static int g_soft_ms = 0;
 static int g_hard_ms = 0;
-static std::atomic<std::uint64_t> g_nodes{0};
+
+// Lazy SMP: every thread runs its own iterative deepening on a private board
+// and shares only the TT. Thread 0 reports and owns the clock; helpers stop
+// when it finishes.
+static constexpr int MAX_THREADS = 256;
+static int g_threads = 1;
+static thread_local int t_thread = 0;       // index of the running search thread
+static thread_local bool t_stopped = false; // this thread hit the stop check
+
+// per-thread node counters, one cache line each; only the owner writes
+struct alignas(64) NodeCount {
+    std::atomic<std::uint64_t> n{0};
+};
+static NodeCount g_nodes[MAX_THREADS];
+
+static inline void count_node()
+{
+    auto& c = g_nodes[t_thread].n;
+    c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+static std::uint64_t total_nodes()
+{
+    std::uint64_t n = 0;
+    for (int i = 0; i < g_threads; ++i)
+        n += g_nodes[i].n.load(std::memory_order_relaxed);
+    return n;
+}
 
 static constexpr int MAX_PLY = 128; // for mate score encoding
 static constexpr int MATE_SCORE = 30000;
@@ -48,15 +121,50 @@ static constexpr int MATE_SCORE = 30000;
 static constexpr bool ASP_DEBUG = false; // ! DELETE ASP_DEBUG AFTER NNUE RETRAINING AND TESTING
 static constexpr int ASP_DELTA_CP = 1024;
 
-// 3-fold repetition move stack
-static std::uint64_t g_repstack[MAX_PLY + 4];
+// 3-fold repetition move stack (per thread)
+static thread_local std::uint64_t g_repstack[MAX_PLY + 4];
 
 static constexpr int Q_DELTA_MARGIN = 90;        // centipawns; conservative
 static constexpr bool QS_USE_SEE = true;         // prune obviously losing captures
 static constexpr bool QS_ENABLE_QCHECKS = false; // add checking noncaptures in qsearch quiet nodes
 
-// aborting
+// aborting: g_abort from UCI stop, g_helpers_stop once thread 0 is done
 static std::atomic<bool> g_abort{false};
+static std::atomic<bool> g_helpers_stop{false};
+
+static inline bool stop_requested()
+{
+    return g_abort.load(std::memory_order_relaxed) ||
+           (t_thread != 0 && g_helpers_stop.load(std::memory_order_relaxed));
+}
+
+// Copy-make (CHESSTER_COPY_MAKE) searches each child on a stack copy of the
+// parent and only reverts the NNUE accumulators; otherwise make/unmake in place.
+#if defined(CHESSTER_COPY_MAKE)
+static constexpr bool COPY_MAKE = true;
+#else
+static constexpr bool COPY_MAKE = false;
+#endif
+
+// Plays m and returns the position to search: 'child' under copy-make, else 'b' itself.
+static inline Board& play_move(Board& b, Board& child, Move m, Undo& u, eval::EvalState& es)
+{
+    if constexpr (COPY_MAKE) {
+        copy_make(b, child, m, u, &es);
+        return child;
+    } else {
+        make_move(b, m, u, &es);
+        return b;
+    }
+}
+
+static inline void take_back(Board& b, Move m, Undo& u, eval::EvalState& es)
+{
+    if constexpr (COPY_MAKE)
+        eval::revert(es, u.nnue);
+    else
+        unmake_move(b, m, u, &es);
+}
 
 void request_stop()
 {
@@ -67,15 +175,6 @@ void reset_stop()
     g_abort.store(false, std::memory_order_relaxed);
 }
 
-static inline bool gives_check(Board& b, eval::EvalState& es, Move m)
-{
-    Undo u;
-    make_move(b, m, u, &es);
-    bool gc = in_check(b);
-    unmake_move(b, m, u, &es);
-    return gc;
-}
-
 static inline bool is_threefold(const Board& b, int ply)
 {
     std::uint64_t k = b.zkey();
@@ -149,12 +248,12 @@ static inline int decode_tt_mate_score(int s, int ply)
 // Move ordering machinery
 namespace {
 
-// two killer moves per ply (quiet moves that caused beta cutoffs)
-static Move g_killer1[MAX_PLY];
-static Move g_killer2[MAX_PLY];
+// two killer moves per ply (quiet moves that caused beta cutoffs), per thread
+static thread_local Move g_killer1[MAX_PLY];
+static thread_local Move g_killer2[MAX_PLY];
 
-// STM history table: history[side][from][to]
-static int g_history[2][64][64];
+// STM history table: history[side][from][to], per thread
+static thread_local int g_history[2][64][64];
 
 // Piece 'values' for MVV/LVA (relative ordering)
 // static constexpr int PVAL[6] = {100, 320, 330, 500, 900, 20000}; // P,N,B,R,Q,K
@@ -242,7 +341,7 @@ inline int score_move(const Board& b, Move m, Move ttBest, int ply)
 }
 
 // Sort helper
-inline void order_moves(Board& b, std::vector<Move>& moves, int ply)
+inline void order_moves(Board& b, MoveList& moves, int ply)
 {
     Move ttBest = 0;
     int dummy;
@@ -250,12 +349,14 @@ inline void order_moves(Board& b, std::vector<Move>& moves, int ply)
 
     (void)tt_probe(b, 0, -30000, 30000, ply, dummy, ttBest);
 
-    std::stable_sort(moves.begin(), moves.end(), [&](Move m1, Move m2) {
+    // ties are broken on the move itself, so this is a total order and std::sort
+    // gives the same result as a stable sort without its temporary buffer
+    std::sort(moves.begin(), moves.end(), [&](Move m1, Move m2) {
         int sa = score_move(b, m1, ttBest, ply);
         int sb = score_move(b, m2, ttBest, ply);
         if (sa != sb)
             return sa > sb;
-        return m1 < m2; // stable
+        return m1 < m2;
     });
 }
 
@@ -297,41 +398,71 @@ static inline std::uint64_t pos_key(const Board& b)
     return b.zkey();
 }
 
-static inline TTEntry& tt_slot(std::uint64_t key)
+static inline std::uint64_t tt_pack(const TTEntry& e)
 {
-    return g_tt[key & TT_MASK];
+    return static_cast<std::uint64_t>(e.best) | (static_cast<std::uint64_t>(static_cast<std::uint16_t>(e.score)) << 16) |
+           (static_cast<std::uint64_t>(static_cast<std::uint16_t>(e.eval)) << 32) |
+           (static_cast<std::uint64_t>(e.depth8) << 48) | (static_cast<std::uint64_t>(e.genBound) << 56);
+}
+
+static inline TTEntry tt_unpack(std::uint64_t data)
+{
+    return {static_cast<Move>(data), static_cast<std::int16_t>(data >> 16), static_cast<std::int16_t>(data >> 32),
+            static_cast<std::uint8_t>(data >> 48), static_cast<std::uint8_t>(data >> 56)};
+}
+
+// Searches since the entry was written, in whole generations
+static inline int tt_age(const TTEntry& e)
+{
+    return static_cast<std::uint8_t>(g_tt_gen - (e.genBound & ~TT_BOUND_MASK)) / TT_GEN_DELTA;
+}
+
+// Reads the entry for key from its bucket; false if absent or torn
+static inline bool tt_lookup(std::uint64_t key, TTEntry& out)
+{
+    const TTBucket& bucket = g_tt[key & g_tt_mask];
+    for (const TTSlot& s : bucket.entry) {
+        const std::uint64_t data = s.data.load(std::memory_order_relaxed);
+        const std::uint64_t check = s.check.load(std::memory_order_relaxed);
+        if ((check ^ data) == key && data) {
+            out = tt_unpack(data);
+            return out.depth8 != 0;
+        }
+    }
+    return false;
 }
 
 // Probe: returns true iff entry can be used to cut or exact return.
 // always returns a move hint (outBest) if present, even if not cut-usable.
 static inline bool tt_probe(const Board& b, int depth, int alpha, int beta, int ply, int& outScore, Move& outBest)
 {
-    const std::uint64_t k = pos_key(b);
-    TTEntry& e = tt_slot(k);
+    TTEntry e;
 
-    // if entry at idx does not match key, or is empty
-    if (e.key != k || e.flag == TT_EMPTY) {
+    // no entry for this key in its bucket
+    if (!tt_lookup(pos_key(b), e)) {
         return false;
     }
 
     if (e.best)
         outBest = e.best;
 
+    const uint8_t flag = e.genBound & TT_BOUND_MASK;
+
     // searched this position deeper (or equal) previously
-    if (e.depth >= depth) {
+    if (e.depth8 - TT_DEPTH_OFFSET >= depth) {
         const int dec = decode_tt_mate_score(e.score, ply);
 
-        if (e.flag == TT_EXACT) {
+        if (flag == TT_EXACT) {
             outScore = dec;
             return true;
         }
 
-        if (e.flag == TT_LOWER && dec >= beta) {
+        if (flag == TT_LOWER && dec >= beta) {
             outScore = dec;
             return true;
         }
 
-        if (e.flag == TT_UPPER && dec <= alpha) {
+        if (flag == TT_UPPER && dec <= alpha) {
             outScore = dec;
             return true;
         }
@@ -339,29 +470,272 @@ static inline bool tt_probe(const Board& b, int depth, int alpha, int beta, int
     return false;
 }
 
-// Store or replace an entry (unconditional). Replace if depth is greater/equal.
-static inline void tt_store(const Board& b, int depth, int score, uint8_t flag, Move best, int ply)
+// Store into the bucket: the entry for the same key if present, else an empty
+// one, else the one worth least (shallow and old). The same position is only
+// overwritten by an equal or deeper search, or when its entry is from an
+// earlier search; the move and eval are kept if the new store has none.
+static inline void tt_store(const Board& b, int depth, int score, uint8_t flag, Move best, int ply,
+                            int eval = EVAL_NONE)
 {
     const std::uint64_t k = pos_key(b);
-    TTEntry& e = tt_slot(k);
+    TTBucket& bucket = g_tt[k & g_tt_mask];
+
+    auto worth = [](const TTEntry& e) { return e.depth8 - 8 * tt_age(e); };
+
+    TTSlot* slot = nullptr;
+    TTEntry old{};
+    bool same = false;
+    for (TTSlot& s : bucket.entry) {
+        const std::uint64_t data = s.data.load(std::memory_order_relaxed);
+        const TTEntry e = tt_unpack(data);
+        if (!e.depth8 || (s.check.load(std::memory_order_relaxed) ^ data) == k) {
+            slot = &s;
+            old = e;
+            same = e.depth8 != 0;
+            break;
+        }
+        if (!slot || worth(e) < worth(old)) {
+            slot = &s;
+            old = e;
+        }
+    }
+
+    TTEntry e{best, 0, static_cast<std::int16_t>(eval), 0, 0};
+    if (same) {
+        if (!e.best)
+            e.best = old.best;
+        if (eval == EVAL_NONE)
+            e.eval = old.eval;
+        if (flag == TT_NONE || (depth + TT_DEPTH_OFFSET < old.depth8 && tt_age(old) == 0)) {
+            // keep the deeper result; only refresh its move and eval
+            e.score = old.score;
+            e.depth8 = old.depth8;
+            e.genBound = old.genBound;
+        }
+    }
+    if (!e.depth8) {
+        e.score = static_cast<std::int16_t>(encode_tt_mate_score(score, ply));
+        e.depth8 = static_cast<std::uint8_t>(depth + TT_DEPTH_OFFSET);
+        e.genBound = static_cast<std::uint8_t>(g_tt_gen | flag);
+    }
 
-    const int enc = encode_tt_mate_score(score, ply);
+    const std::uint64_t data = tt_pack(e);
+    slot->check.store(k ^ data, std::memory_order_relaxed);
+    slot->data.store(data, std::memory_order_relaxed);
+}
 
-    if (e.flag == TT_EMPTY || e.key != k || e.depth <= depth) {
-        e.key = k;
-        e.best = best;
-        e.score = enc;
-        e.depth = static_cast<int16_t>(depth);
-        e.flag = flag;
+// Start of a SharedHash segment, before the buckets. A process only adopts a
+// segment whose header matches its own entry format; a stale one left by a
+// build with another layout would otherwise be read as garbage entries.
+struct alignas(64) TTShmHeader {
+    std::uint64_t magic;
+    std::uint32_t version;
+    std::uint64_t buckets;
+};
+
+static constexpr std::uint64_t TT_SHM_MAGIC = 0x43485354545348ULL; // "CHSTTSH"
+static constexpr std::uint32_t TT_SHM_VERSION = 1; // bump when TTSlot/TTEntry packing changes
+
+static constexpr std::size_t HUGE_PAGE = 2 * 1024 * 1024;
+
+static void tt_free()
+{
+    switch (g_tt_memory) {
+#if defined(__linux__)
+    case TTMemory::HUGETLB:
+        munmap(g_tt, g_tt_bytes);
+        break;
+    case TTMemory::SHARED:
+        munmap(reinterpret_cast<char*>(g_tt) - sizeof(TTShmHeader), g_tt_bytes);
+        break;
+    case TTMemory::THP:
+        std::free(g_tt);
+        break;
+#endif
+    case TTMemory::HEAP:
+        ::operator delete(g_tt, std::align_val_t{alignof(TTBucket)});
+        break;
+    default:
+        break;
+    }
+    g_tt = nullptr;
+    g_tt_bytes = 0;
+    g_tt_memory = TTMemory::NONE;
+}
+
+// Raw memory for 'bytes' of buckets, on huge pages where possible
+static void tt_alloc(std::size_t bytes)
+{
+#if defined(__linux__)
+    const std::size_t rounded = (bytes + HUGE_PAGE - 1) & ~(HUGE_PAGE - 1);
+
+    void* p = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p != MAP_FAILED) {
+        g_tt = static_cast<TTBucket*>(p);
+        g_tt_bytes = rounded;
+        g_tt_memory = TTMemory::HUGETLB;
+        return;
+    }
+
+    p = std::aligned_alloc(HUGE_PAGE, rounded);
+    if (p) {
+        madvise(p, rounded, MADV_HUGEPAGE); // advice only; may be ignored
+        g_tt = static_cast<TTBucket*>(p);
+        g_tt_bytes = rounded;
+        g_tt_memory = TTMemory::THP;
+        return;
+    }
+#endif
+    void* q = ::operator new(bytes, std::align_val_t{alignof(TTBucket)});
+    g_tt = static_cast<TTBucket*>(q);
+    g_tt_bytes = bytes;
+    g_tt_memory = TTMemory::HEAP;
+}
+
+// Maps the g_tt_shm segment, creating it with 'buckets' if it does not exist.
+// An existing segment keeps its size, so every process indexes it alike; a
+// new one is zero-filled, which is an empty table. false if it cannot be used.
+static bool tt_map_shared(std::size_t buckets)
+{
+#if defined(__linux__)
+    const int fd = shm_open(g_tt_shm.c_str(), O_RDWR | O_CREAT, 0600);
+    if (fd < 0)
+        return false;
+
+    // the first process to take the lock sizes the segment and writes the
+    // header; later ones check it before using the table
+    flock(fd, LOCK_EX);
+    struct stat st {};
+    TTShmHeader h{};
+    bool ok = fstat(fd, &st) == 0;
+    if (ok && st.st_size == 0) {
+        h = {TT_SHM_MAGIC, TT_SHM_VERSION, buckets};
+        ok = ftruncate(fd, static_cast<off_t>(sizeof(h) + buckets * sizeof(TTBucket))) == 0 &&
+             pwrite(fd, &h, sizeof(h), 0) == static_cast<ssize_t>(sizeof(h));
+    } else if (ok) {
+        const std::size_t size = static_cast<std::size_t>(st.st_size);
+        ok = size >= sizeof(h) && pread(fd, &h, sizeof(h), 0) == static_cast<ssize_t>(sizeof(h)) &&
+             h.magic == TT_SHM_MAGIC && h.version == TT_SHM_VERSION && h.buckets &&
+             (h.buckets & (h.buckets - 1)) == 0 && h.buckets <= size / sizeof(TTBucket) &&
+             size == sizeof(h) + h.buckets * sizeof(TTBucket);
+    }
+    flock(fd, LOCK_UN);
+
+    const std::size_t bytes = sizeof(h) + h.buckets * sizeof(TTBucket);
+    void* p = ok ? mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (p == MAP_FAILED)
+        return false;
+
+    madvise(p, bytes, MADV_HUGEPAGE); // honoured if shmem huge pages are set to 'advise'
+    g_tt = reinterpret_cast<TTBucket*>(static_cast<char*>(p) + sizeof(TTShmHeader));
+    g_tt_bytes = bytes;
+    g_tt_memory = TTMemory::SHARED;
+    return true;
+#else
+    (void)buckets;
+    return false;
+#endif
+}
+
+// Allocates a table of g_tt_mb: the g_tt_shm segment when one is named and
+// usable, else private memory.
+static void tt_allocate()
+{
+    // power-of-two bucket count, like the perft table
+    std::size_t n = 1;
+    while (2 * n * sizeof(TTBucket) <= g_tt_mb * 1024 * 1024)
+        n *= 2;
+
+    if (!g_tt_shm.empty() && tt_map_shared(n)) {
+        // other processes may own the table: no construction
+        n = (g_tt_bytes - sizeof(TTShmHeader)) / sizeof(TTBucket);
+    } else {
+        tt_alloc(n * sizeof(TTBucket));
+        for (std::size_t i = 0; i < n; ++i)
+            new (&g_tt[i]) TTBucket; // empty slots; also faults the pages in now
+    }
+    g_tt_mask = n - 1;
+}
+
+void tt_resize(std::size_t megabytes)
+{
+    tt_free(); // free the old table before allocating the new one
+    g_tt_mb = megabytes;
+    // a shared segment is only mapped by the first search, so the last Hash
+    // sent before it decides the size of a segment this process creates
+    if (g_tt_shm.empty())
+        tt_allocate();
+}
+
+void tt_set_shared(const std::string& name)
+{
+    g_tt_shm = name;
+    if (!g_tt_shm.empty() && g_tt_shm.front() != '/')
+        g_tt_shm.insert(g_tt_shm.begin(), '/');
+    tt_free(); // the first search maps the segment or allocates a private table
+}
+
+std::size_t tt_size_mb()
+{
+    return g_tt ? (g_tt_mask + 1) * sizeof(TTBucket) / (1024 * 1024) : 0;
+}
+
+bool tt_is_shared()
+{
+    return g_tt_memory == TTMemory::SHARED;
+}
+
+const char* tt_backend()
+{
+    switch (g_tt_memory) {
+    case TTMemory::HUGETLB:
+        return "hugetlb";
+    case TTMemory::THP:
+        return "thp";
+    case TTMemory::HEAP:
+        return "heap";
+    case TTMemory::SHARED:
+        return "shared";
+    default:
+        return "none";
     }
 }
 
 // helper for between game clears
 void tt_clear()
 {
-    for (std::size_t i = 0; i < TT_SIZE; ++i) {
-        g_tt[i] = TTEntry{};
+    for (std::size_t i = 0; g_tt && i <= g_tt_mask; ++i) {
+        for (TTSlot& s : g_tt[i].entry) {
+            s.check.store(0, std::memory_order_relaxed);
+            s.data.store(0, std::memory_order_relaxed);
+        }
     }
+    g_tt_gen = 0;
+}
+
+// Pull the bucket for a child's key into cache while the move is being made
+static inline void tt_prefetch(std::uint64_t key)
+{
+    __builtin_prefetch(&g_tt[key & g_tt_mask]);
+}
+
+int tt_hashfull()
+{
+    // permille of the first 1000 buckets' entries written by this search
+    const std::size_t n = std::min<std::size_t>(1000, g_tt_mask + 1);
+    int used = 0;
+    for (std::size_t i = 0; i < n; ++i)
+        for (const TTSlot& s : g_tt[i].entry) {
+            const TTEntry e = tt_unpack(s.data.load(std::memory_order_relaxed));
+            used += e.depth8 && tt_age(e) == 0;
+        }
+    return static_cast<int>(used * 1000 / (n * TT_BUCKET_ENTRIES));
+}
+
+void set_threads(int n)
+{
+    g_threads = std::clamp(n, 1, MAX_THREADS);
 }
 
 static inline bool time_enabled()
@@ -384,17 +758,18 @@ static inline bool past_hard()
 // Quiesence search (captures and promotions only)
 static inline int qsearch(Board& b, eval::EvalState& es, int alpha, int beta)
 {
-    g_nodes.fetch_add(1, std::memory_order_relaxed);
+    count_node();
 
-    if (time_enabled()) {
-        static thread_local int tick = 0;
-        if ((++tick & 31) == 0 && (past_hard() || g_abort.load(std::memory_order_relaxed)))
-            return eval::evaluate(es);
+    static thread_local int tick = 0;
+    if ((++tick & 31) == 0 && (past_hard() || stop_requested())) {
+        t_stopped = true;
+        return eval::evaluate(es);
     }
 
     // If we're in check at qsearch, we must search evasions (no stand-pat).
     if (in_check(b)) {
-        std::vector<Move> moves = generate_legal_moves(b);
+        MoveList moves;
+        generate<EVASIONS>(b, moves);
         order_moves(b, moves, 0);
 
         if (moves.empty())
@@ -402,9 +777,9 @@ static inline int qsearch(Board& b, eval::EvalState& es, int alpha, int beta)
 
         for (Move m : moves) {
             Undo u;
-            make_move(b, m, u, &es);
-            int score = -qsearch(b, es, -beta, -alpha);
-            unmake_move(b, m, u, &es);
+            Board child;
+            int score = -qsearch(play_move(b, child, m, u, es), es, -beta, -alpha);
+            take_back(b, m, u, es);
 
             if (score > alpha) {
                 alpha = score;
@@ -415,24 +790,30 @@ static inline int qsearch(Board& b, eval::EvalState& es, int alpha, int beta)
         return alpha;
     }
 
-    // normal stand-pat
-    int stand = eval::evaluate(es);
+    // normal stand-pat; the static eval is cached in the TT
+    int stand;
+    if (TTEntry e; tt_lookup(pos_key(b), e) && e.eval != EVAL_NONE) {
+        stand = e.eval;
+    } else {
+        stand = eval::evaluate(es);
+        tt_store(b, DEPTH_QS, 0, TT_NONE, 0, 0, stand);
+    }
     if (stand >= beta)
         return stand;
     if (stand > alpha)
         alpha = stand;
 
-    std::vector<Move> moves = generate_legal_moves(b);
+    // tactical moves only; quiet checks are appended when enabled
+    MoveList moves;
+    generate<CAPTURES>(b, moves);
+    if (QS_ENABLE_QCHECKS)
+        generate<QUIET_CHECKS>(b, moves);
     order_moves(b, moves, 0);
 
     for (Move m : moves) {
         const bool isCap = is_capture(m);
         const bool isPromo = is_promo_any(m);
 
-        if (!(isCap || isPromo))
-            if (!QS_ENABLE_QCHECKS || !gives_check(b, es, m))
-                continue;
-
         // Delta pruning (skip if even optimistic bound cant raise alpha)
         // Upper bound gain from the move: captured piece + promo gain (if any)
         // Avoid delta pruning pure promotions - they can be very good.
@@ -455,9 +836,9 @@ static inline int qsearch(Board& b, eval::EvalState& es, int alpha, int beta)
         }
 
         Undo u;
-        make_move(b, m, u, &es);
-        int score = -qsearch(b, es, -beta, -alpha);
-        unmake_move(b, m, u, &es);
+        Board child;
+        int score = -qsearch(play_move(b, child, m, u, es), es, -beta, -alpha);
+        take_back(b, m, u, es);
 
         if (score >= beta)
             return score;
@@ -470,18 +851,17 @@ static inline int qsearch(Board& b, eval::EvalState& es, int alpha, int beta)
 // Core search
 static inline int negamax(Board& b, eval::EvalState& es, int depth, int alpha, int beta, int ply)
 {
-    g_nodes.fetch_add(1, std::memory_order_relaxed);
+    count_node();
 
     const int alpha_orig = alpha;
 
-    // Cheap periodic time test
+    // Cheap periodic time and stop test
     static thread_local int check_counter = 0;
-    if (time_enabled()) {
-        // every 32 nodes check if we have exceeded maximum allowable time.
-        if ((++check_counter & 31) == 0 && (past_hard() || g_abort.load(std::memory_order_relaxed))) {
-            // Out of time: return static eval as a bounded fallback
-            return eval::evaluate(es);
-        }
+    // every 32 nodes check if we have exceeded maximum allowable time.
+    if ((++check_counter & 31) == 0 && (past_hard() || stop_requested())) {
+        // Out of time: return static eval as a bounded fallback
+        t_stopped = true;
+        return eval::evaluate(es);
     }
 
     g_repstack[ply] = pos_key(b);
@@ -511,7 +891,8 @@ static inline int negamax(Board& b, eval::EvalState& es, int depth, int alpha, i
     int best = std::numeric_limits<int>::min() / 2;
     Move bestMove = 0;
 
-    std::vector<Move> moves = generate_legal_moves(b);
+    MoveList moves;
+    generate_legal_moves(b, moves);
     if (moves.empty()) {
         // checkmate or stalemate
         int out = in_check(b) ? mated_in(ply) : 0;
@@ -524,26 +905,29 @@ static inline int negamax(Board& b, eval::EvalState& es, int depth, int alpha, i
 
     bool first = true;
     for (Move m : moves) {
+        tt_prefetch(key_after(b, m));
+
         Undo u;
-        make_move(b, m, u, &es);
+        Board child;
+        Board& next = play_move(b, child, m, u, es);
 
         int score;
         if (first) {
             // first move: full window (likely PV)
-            score = -negamax(b, es, depth - 1, -beta, -alpha, ply + 1);
+            score = -negamax(next, es, depth - 1, -beta, -alpha, ply + 1);
             first = false;
         } else {
             // subsequent moves: try cheap null window
             int nwBeta = alpha + 1;
-            score = -negamax(b, es, depth - 1, -nwBeta, -alpha, ply + 1);
+            score = -negamax(next, es, depth - 1, -nwBeta, -alpha, ply + 1);
 
             // Fail high? research with full window to get exact score.
             if (score > alpha) {
-                score = -negamax(b, es, depth - 1, -beta, -alpha, ply + 1);
+                score = -negamax(next, es, depth - 1, -beta, -alpha, ply + 1);
             }
         }
 
-        unmake_move(b, m, u, &es);
+        take_back(b, m, u, es);
 
         if (score > best) {
             best = score;
@@ -558,10 +942,16 @@ static inline int negamax(Board& b, eval::EvalState& es, int depth, int alpha, i
             break; // alpha-beta cutoff
         }
 
-        if (time_enabled() && past_hard())
+        if (time_enabled() && past_hard()) {
+            t_stopped = true;
             break; // hit hard wall mid-iteration
+        }
     }
 
+    // a stopped subtree returns fallback scores; keep them out of the shared TT
+    if (t_stopped)
+        return best;
+
     // Store to TT
     uint8_t flag = TT_EXACT;
     if (best <= alpha_orig)
@@ -573,13 +963,19 @@ static inline int negamax(Board& b, eval::EvalState& es, int depth, int alpha, i
     return best;
 }
 
-// Iterative deepening with (soft, hard) time limits in ms.
-Move search_best_move_timed(Board& b, int maxDepth, int soft_ms, int hard_ms)
+// What one thread's iterative deepening settled on
+struct ThreadResult {
+    Move best = 0;
+    int score = 0;
+    int depth = 0; // last fully searched depth
+};
+
+// Iterative deepening with aspiration windows for search thread 'id'. Thread 0
+// prints UCI info (with the node count of all threads) and owns the clock.
+static void iterate(Board& b, int maxDepth, int id, ThreadResult& out)
 {
-    g_start = clock::now();
-    g_soft_ms = soft_ms;
-    g_hard_ms = hard_ms;
-    g_nodes = 0;
+    t_thread = id;
+    t_stopped = false;
 
     clear_move_ordering();
 
@@ -593,17 +989,15 @@ Move search_best_move_timed(Board& b, int maxDepth, int soft_ms, int hard_ms)
     bool have_last = false;
     int last_score = 0;
 
-    std::vector<Move> rootMoves = generate_legal_moves(b);
-    if (!rootMoves.empty()) {
-        order_moves(b, rootMoves, 0);
-        best_move = rootMoves[0];
-    } else {
-        // no legal moves: checkmate or stalemate
-        return 0;
-    }
+    MoveList rootMoves;
+    generate_legal_moves(b, rootMoves);
+    order_moves(b, rootMoves, 0);
+    best_move = rootMoves[0];
+    out.best = best_move;
 
-    for (int d = 1; d <= maxDepth; ++d) {
-        if (g_abort.load(std::memory_order_relaxed))
+    // odd helpers skip depth 1 so the threads are spread over two depths
+    for (int d = 1 + (id & 1); d <= maxDepth; ++d) {
+        if (stop_requested())
             break;
 
         // Reset aspiration window each depth
@@ -613,9 +1007,10 @@ Move search_best_move_timed(Board& b, int maxDepth, int soft_ms, int hard_ms)
 
         int best = std::numeric_limits<int>::min() / 2;
         Move local_best = 0;
+        bool complete = false;
 
         while (true) {
-            if (g_abort.load(std::memory_order_relaxed))
+            if (stop_requested())
                 break;
 
             if (time_enabled() && past_hard())
@@ -625,17 +1020,29 @@ Move search_best_move_timed(Board& b, int maxDepth, int soft_ms, int hard_ms)
             best = std::numeric_limits<int>::min() / 2;
             local_best = 0;
 
-            std::vector<Move> moves = generate_legal_moves(b);
+            MoveList moves;
+            generate_legal_moves(b, moves);
             order_moves(b, moves, 0);
 
+            // helpers keep the hash move first but rotate the rest by their
+            // index, so they walk different subtrees first and fill the TT
+            if (id > 0 && moves.size() > 2) {
+                const int shift = 1 + (id - 1) % (moves.size() - 1);
+                std::rotate(moves.begin() + 1, moves.begin() + shift, moves.end());
+            }
+
+            bool cut = false;
             for (Move m : moves) {
-                if (time_enabled() && past_soft())
+                // the soft limit never cuts the first iteration short
+                if (have_last && time_enabled() && past_soft()) {
+                    cut = true;
                     break;
+                }
 
                 Undo u;
-                make_move(b, m, u, &es);
-                int score = -negamax(b, es, d - 1, -beta, -alpha, 1);
-                unmake_move(b, m, u, &es);
+                Board child;
+                int score = -negamax(play_move(b, child, m, u, es), es, d - 1, -beta, -alpha, 1);
+                take_back(b, m, u, es);
 
                 if (score > best) {
                     best = score;
@@ -651,7 +1058,7 @@ Move search_best_move_timed(Board& b, int maxDepth, int soft_ms, int hard_ms)
             if (time_enabled() && past_hard())
                 break;
 
-            if (g_abort.load(std::memory_order_relaxed))
+            if (stop_requested())
                 break;
 
             // aspiration result check (use the tried window, not the updated alpha/beta)
@@ -690,148 +1097,143 @@ Move search_best_move_timed(Board& b, int maxDepth, int soft_ms, int hard_ms)
                 }
                 continue;
             }
+            complete = !t_stopped && !cut;
             break; // score inside window
         }
 
+        // a stopped or cut iteration saw only part of the root moves, some with
+        // fallback scores; keep the move, score and depth of the last full one
+        if (!complete)
+            break;
+
         if (local_best)
             best_move = local_best;
         last_score = best;
         have_last = true;
 
+        out.best = best_move;
+        out.score = best;
+        out.depth = d;
+
+        if (id != 0)
+            continue;
+
         using namespace std::chrono;
         auto ms = duration_cast<milliseconds>(clock::now() - g_start).count();
-        auto nodes = g_nodes.load(std::memory_order_relaxed);
+        auto nodes = total_nodes();
         long nps = ms > 0 ? static_cast<long>((nodes * 1000) / ms) : 0;
         if (is_mate_band(best)) {
             int m = mate_ply_from_root(best, /*ply=*/0); // root
             std::cout << "info depth " << d << " score mate " << m << " time " << ms << " nodes " << nodes << " nps "
-                      << nps << " pv " << move_to_uci(best_move) << "\n";
+                      << nps << " hashfull " << tt_hashfull() << " pv " << move_to_uci(best_move) << "\n";
         } else {
             std::cout << "info depth " << d << " score cp " << best << " time " << ms << " nodes " << nodes << " nps "
-                      << nps << " pv " << move_to_uci(best_move) << "\n";
+                      << nps << " hashfull " << tt_hashfull() << " pv " << move_to_uci(best_move) << "\n";
         }
 
         if (time_enabled() && past_soft())
             break;
     }
-
-    g_soft_ms = g_hard_ms = 0;
-    return best_move;
 }
 
-// Fixed-depth (no time limits); still prints UCI info per depth.
-Move search_best_move(Board& b, int depth)
+// Lazy SMP vote: each thread backs its move with (score - worst + 14) * depth;
+// a proven mate overrides the vote. Ties go to the main thread.
+static Move pick_best(const std::vector<ThreadResult>& results)
 {
-    auto start = clock::now();
-    g_nodes = 0;
-
-    clear_move_ordering();
-
-    // Seed repetition stack at root
-    g_repstack[0] = pos_key(b);
-
-    eval::EvalState es;
-    eval::init_position(b, es);
-
-    Move best_move = 0;
-    bool have_last = false;
-    int last_score = 0;
+    int worst = results[0].score;
+    for (const ThreadResult& r : results)
+        if (r.depth > 0)
+            worst = std::min(worst, r.score);
+
+    auto votes = [&](Move m) {
+        long v = 0;
+        for (const ThreadResult& r : results)
+            if (r.best == m)
+                v += static_cast<long>(r.score - worst + 14) * r.depth;
+        return v;
+    };
+
+    const ThreadResult* best = &results[0];
+    for (const ThreadResult& r : results) {
+        if (!r.best || r.depth == 0)
+            continue;
+        if (is_mate_band(best->score) && best->score > 0) {
+            if (r.score > best->score)
+                best = &r;
+        } else if ((is_mate_band(r.score) && r.score > 0) || votes(r.best) > votes(best->best)) {
+            best = &r;
+        }
+    }
+    return best->best;
+}
 
-    std::vector<Move> rootMoves = generate_legal_moves(b);
-    if (!rootMoves.empty()) {
-        order_moves(b, rootMoves, 0);
-        best_move = rootMoves[0];
-    } else {
+// Runs g_threads searches of b side by side and returns the voted move.
+static Move search_threads(Board& b, int maxDepth)
+{
+    MoveList rootMoves;
+    generate_legal_moves(b, rootMoves);
+    if (rootMoves.empty()) {
         // no legal moves: checkmate or stalemate
         return 0;
     }
 
-    for (int d = 1; d <= depth; ++d) {
-        int delta = have_last ? ASP_DELTA_CP : 500;
-        int alpha_try = have_last ? (last_score - delta) : -MATE_SCORE;
-        int beta_try = have_last ? (last_score + delta) : MATE_SCORE;
+    g_tt_gen = static_cast<std::uint8_t>(g_tt_gen + TT_GEN_DELTA);
 
-        int best = std::numeric_limits<int>::min() / 2;
-        Move local_best = 0;
-
-        while (true) {
-            int alpha = alpha_try, beta = beta_try;
-            best = std::numeric_limits<int>::min() / 2;
-            local_best = 0;
+    for (int i = 0; i < g_threads; ++i)
+        g_nodes[i].n.store(0, std::memory_order_relaxed);
 
-            std::vector<Move> moves = generate_legal_moves(b);
-            order_moves(b, moves, 0);
+    std::vector<ThreadResult> results(g_threads);
+    std::vector<std::thread> helpers;
+    g_helpers_stop.store(false, std::memory_order_relaxed);
+    for (int i = 1; i < g_threads; ++i) {
+        // copy the root here: thread 0 starts playing moves on b right away
+        helpers.emplace_back([local = b, &results, maxDepth, i]() mutable {
+            iterate(local, maxDepth, i, results[i]);
+        });
+    }
 
-            for (Move m : moves) {
-                Undo u;
-                make_move(b, m, u, &es);
-                int score = -negamax(b, es, d - 1, -beta, -alpha, 1);
-                unmake_move(b, m, u, &es);
+    iterate(b, maxDepth, 0, results[0]);
 
-                if (score > best) {
-                    best = score;
-                    local_best = m;
-                }
-                if (best > alpha)
-                    alpha = best;
-            }
+    g_helpers_stop.store(true, std::memory_order_relaxed);
+    for (auto& th : helpers)
+        th.join();
 
-            if (best <= alpha_try) {
-                int oldA = alpha_try, oldB = beta_try, oldDelta = delta;
-                delta *= 2;
-                alpha_try = (have_last ? last_score : best) - delta;
-                beta_try = (have_last ? last_score : best) + delta;
-                if (alpha_try < -MATE_SCORE)
-                    alpha_try = -MATE_SCORE;
-                if (beta_try > MATE_SCORE)
-                    beta_try = MATE_SCORE;
+    return pick_best(results);
+}
 
-                if (ASP_DEBUG) {
-                    std::cout << "info string asp depth " << d << " fail-low last=" << (have_last ? last_score : best)
-                              << " best=" << best << " win0=[" << oldA << "," << oldB << "] Δ0=" << oldDelta
-                              << " -> win1=[" << alpha_try << "," << beta_try << "] Δ1=" << delta << "\n";
-                }
-                continue;
-            } else if (best >= beta_try) {
-                int oldA = alpha_try, oldB = beta_try, oldDelta = delta;
-                delta *= 2;
-                alpha_try = (have_last ? last_score : best) - delta;
-                beta_try = (have_last ? last_score : best) + delta;
-                if (alpha_try < -MATE_SCORE)
-                    alpha_try = -MATE_SCORE;
-                if (beta_try > MATE_SCORE)
-                    beta_try = MATE_SCORE;
+// The TT is allocated on first use, before the clock starts: faulting in the
+// table can take longer than a short move's whole budget. A SharedHash table
+// reports what it got, as an existing segment keeps its own size.
+static void tt_ensure()
+{
+    if (g_tt)
+        return;
+    tt_allocate();
+    if (!g_tt_shm.empty())
+        std::cout << "info string SharedHash " << g_tt_shm << " " << tt_size_mb() << " MB (" << tt_backend() << ")\n";
+}
 
-                if (ASP_DEBUG) {
-                    std::cout << "info string asp depth " << d << " fail-high last=" << (have_last ? last_score : best)
-                              << " best=" << best << " win0=[" << oldA << "," << oldB << "] Δ0=" << oldDelta
-                              << " -> win1=[" << alpha_try << "," << beta_try << "] Δ1=" << delta << "\n";
-                }
-                continue;
-            }
-            break; // success inside window
-        }
+// Iterative deepening with (soft, hard) time limits in ms.
+Move search_best_move_timed(Board& b, int maxDepth, int soft_ms, int hard_ms)
+{
+    tt_ensure();
+    g_start = clock::now();
+    g_soft_ms = soft_ms;
+    g_hard_ms = hard_ms;
 
-        if (local_best)
-            best_move = local_best;
-        last_score = best;
-        have_last = true;
+    Move best = search_threads(b, maxDepth);
 
-        using namespace std::chrono;
-        auto ms = duration_cast<milliseconds>(clock::now() - start).count();
-        auto nodes = g_nodes.load(std::memory_order_relaxed);
-        long nps = ms > 0 ? static_cast<long>((nodes * 1000) / ms) : 0;
-        if (is_mate_band(best)) {
-            int m = mate_ply_from_root(best, /*ply=*/0); // root
-            std::cout << "info depth " << d << " score mate " << m << " time " << ms << " nodes " << nodes << " nps "
-                      << nps << " pv " << move_to_uci(best_move) << "\n";
-        } else {
-            std::cout << "info depth " << d << " score cp " << best << " time " << ms << " nodes " << nodes << " nps "
-                      << nps << " pv " << move_to_uci(best_move) << "\n";
-        }
-    }
+    g_soft_ms = g_hard_ms = 0;
+    return best;
+}
 
-    return best_move;
+// Fixed-depth (no time limits); still prints UCI info per depth.
+Move search_best_move(Board& b, int depth)
+{
+    tt_ensure();
+    g_start = clock::now();
+    g_soft_ms = g_hard_ms = 0;
+    return search_threads(b, depth);
 }
 
 } // namespace engine
@@ -2,6 +2,9 @@
 #include "board.hh"
 #include "move.hh"
 
+#include <cstddef>
+#include <string>
+
 namespace engine {
 
 Move search_best_move_timed(Board& b, int maxDepth, int soft_ms, int hard_ms);
@@ -10,6 +13,33 @@ Move search_best_move(Board& b, int depth);
 
 void tt_clear(); // allow UCI to wipe TT on ucinewgame
 
+// Reallocate the TT at the given size in MB (rounded down to a power of two
+// of 64-byte buckets); the contents are lost. With SharedHash set this only
+// records the size for the segment mapped by the next search.
+void tt_resize(std::size_t megabytes);
+
+// Memory behind the TT: "hugetlb", "thp" (transparent huge pages), "heap",
+// "shared", or "none" before the first allocation
+const char* tt_backend();
+
+// Keep the TT in the named POSIX shared-memory segment (e.g. "/chesster-tt"),
+// so engine processes on one host that use the same name share a table. The
+// segment is mapped by the next search: the first process creates it at the
+// Hash size set by then and later ones adopt that size. "" goes back to a
+// private table. Falls back to a private table if the segment cannot be
+// mapped; tt_backend() tells which one is in use.
+void tt_set_shared(const std::string& name);
+bool tt_is_shared();
+
+// Size of the TT in use in MB, 0 while a shared table waits for the first search
+std::size_t tt_size_mb();
+
+// Permille of sampled TT entries written by the current search (UCI hashfull)
+int tt_hashfull();
+
+// Lazy SMP: number of threads searching side by side (clamped to 1..256)
+void set_threads(int n);
+
 void request_stop();
 
 void reset_stop();
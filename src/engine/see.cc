@@ -2,6 +2,7 @@
 
 #include "attack_tables.hh"
 #include "bitboard.hh"
+#include "magic.hh"
 #include "util.hh"
 
 #include <algorithm>
@@ -26,24 +27,6 @@ static inline void snap_from_board(const Board& b, Snap& s)
             s.pcs[c][p] = b.pieces[c][p];
 }
 
-static inline Bitboard occ_all(const Snap& s)
-{
-    Bitboard o = 0;
-    for (int c = 0; c < 2; ++c)
-        for (int p = 0; p < 6; ++p)
-            o |= s.pcs[c][p];
-    return o;
-}
-
-static inline Piece piece_on_snap(const Snap& s, Colour c, int sq)
-{
-    Bitboard m = bb_from(sq);
-    for (int p = PAWN; p <= KING; ++p)
-        if (s.pcs[c][p] & m)
-            return (Piece)p;
-    return NO_PIECE;
-}
-
 static inline void remove_piece(Snap& s, Colour c, Piece p, int sq)
 {
     s.pcs[c][p] &= ~bb_from(sq);
@@ -54,79 +37,22 @@ static inline void add_piece(Snap& s, Colour c, Piece p, int sq)
     s.pcs[c][p] |= bb_from(sq);
 }
 
-// First-blocker-from-target ray test. If the first blocker on step
-// is a (c, sliderOK) it counts as an attacker.
-template <Bitboard (*STEP)(Bitboard)> static inline Bitboard first_blocker_mask(Bitboard occ, int targetSq)
-{
-    Bitboard r = bb_from(targetSq);
-    while (true) {
-        r = STEP(r);
-        if (!r)
-            break;
-        if (r & occ)
-            return r;
-    }
-    return 0ULL;
-}
-
 static Bitboard attackers_to_sq(const Snap& s, Bitboard occ, int sq, Colour side)
 {
-    Bitboard target = bb_from(sq);
     Bitboard att = 0ULL;
 
-    // pawns
-    if (side == WHITE) {
-        att |= (se(target) | sw(target)) & s.pcs[WHITE][PAWN];
-    } else {
-        att |= (ne(target) | nw(target)) & s.pcs[BLACK][PAWN];
-    }
+    // pawns: from where an opposing pawn on sq would attack
+    att |= PAWN_ATTACKS[side ^ 1][sq] & s.pcs[side][PAWN];
 
     // knights
     att |= KNIGHT_ATTACKS[sq] & s.pcs[side][KNIGHT];
 
     // king
-    {
-        Bitboard ring = north(target) | south(target) | east(target) | west(target) | ne(target) | nw(target) |
-                        se(target) | sw(target);
-        att |= ring & s.pcs[side][KING];
-    }
+    att |= KING_ATTACKS[sq] & s.pcs[side][KING];
 
-    // Sliders via first-blocker
-    // diagonal queen/bishop
-    {
-        Bitboard b;
-
-        b = first_blocker_mask<north>(occ, sq);
-        if (b && ((b & (s.pcs[side][ROOK] | s.pcs[side][QUEEN]))))
-            att |= b;
-        b = first_blocker_mask<south>(occ, sq);
-        if (b && ((b & (s.pcs[side][ROOK] | s.pcs[side][QUEEN]))))
-            att |= b;
-        b = first_blocker_mask<east>(occ, sq);
-        if (b && ((b & (s.pcs[side][ROOK] | s.pcs[side][QUEEN]))))
-            att |= b;
-        b = first_blocker_mask<west>(occ, sq);
-        if (b && ((b & (s.pcs[side][ROOK] | s.pcs[side][QUEEN]))))
-            att |= b;
-    }
-
-    // Diagonals: bishop/queen
-    {
-        Bitboard b;
-
-        b = first_blocker_mask<ne>(occ, sq);
-        if (b && ((b & (s.pcs[side][BISHOP] | s.pcs[side][QUEEN]))))
-            att |= b;
-        b = first_blocker_mask<nw>(occ, sq);
-        if (b && ((b & (s.pcs[side][BISHOP] | s.pcs[side][QUEEN]))))
-            att |= b;
-        b = first_blocker_mask<se>(occ, sq);
-        if (b && ((b & (s.pcs[side][BISHOP] | s.pcs[side][QUEEN]))))
-            att |= b;
-        b = first_blocker_mask<sw>(occ, sq);
-        if (b && ((b & (s.pcs[side][BISHOP] | s.pcs[side][QUEEN]))))
-            att |= b;
-    }
+    // sliders: magic lookups stop at the first blocker in each direction
+    att |= rook_attacks(sq, occ) & (s.pcs[side][ROOK] | s.pcs[side][QUEEN]);
+    att |= bishop_attacks(sq, occ) & (s.pcs[side][BISHOP] | s.pcs[side][QUEEN]);
 
     return att;
 }
@@ -205,7 +131,7 @@ int see(const Board& b, Move m)
 
     Snap s;
     snap_from_board(b, s);
-    Bitboard occ = occ_all(s);
+    Bitboard occ = occupancy(b);
 
     int gains[32];
     int d = 0;
@@ -213,7 +139,7 @@ int see(const Board& b, Move m)
     // First force the given move (se SEE is about THIS capture, not any other capture)
     // Determine our moving piece and the piece that will sit on 'to' after the move
 
-    Piece mover = piece_on_snap(s, us, from);
+    Piece mover = piece_on(b, us, from);
     if (mover == NO_PIECE) // should never happen
         return 0;
 
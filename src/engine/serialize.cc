@@ -0,0 +1,76 @@
+#include "serialize.hh"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(CHESSTER_VBMI2_DISPATCH) || defined(__AVX512VBMI2__)
+#include <immintrin.h>
+#endif
+
+namespace engine {
+
+bool SERIALIZE_USE_VBMI2 = VBMI2_COMPILED;
+
+#if defined(CHESSTER_VBMI2_DISPATCH) || defined(__AVX512VBMI2__)
+alignas(64) static constexpr std::uint8_t SQUARE_INDEX[64] = {
+        0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21,
+        22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43,
+        44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63};
+
+// Compress the square indices selected by bb into the low bytes, widen to
+// 16 bits and form base + sq * step, 32 moves per store.
+__attribute__((target("avx512f,avx512bw,avx512vbmi2"))) int
+serialize_vbmi2(Move* out, Bitboard bb, unsigned base, unsigned step)
+{
+    const __m512i squares = _mm512_maskz_compress_epi8(bb, _mm512_load_si512(SQUARE_INDEX));
+    const __m512i baseV = _mm512_set1_epi16(static_cast<short>(base));
+    const __m512i stepV = _mm512_set1_epi16(static_cast<short>(step));
+    const int n = __builtin_popcountll(bb);
+
+    const __m512i lo = _mm512_cvtepu8_epi16(_mm512_maskz_extracti64x4_epi64(0xF, squares, 0));
+    _mm512_storeu_si512(out, _mm512_add_epi16(_mm512_mullo_epi16(lo, stepV), baseV));
+    if (n > 32) {
+        const __m512i hi = _mm512_cvtepu8_epi16(_mm512_maskz_extracti64x4_epi64(0xF, squares, 1));
+        _mm512_storeu_si512(out + 32, _mm512_add_epi16(_mm512_mullo_epi16(hi, stepV), baseV));
+    }
+    return n;
+}
+#else
+int serialize_vbmi2(Move* out, Bitboard bb, unsigned base, unsigned step)
+{
+    return serialize_lut(out, bb, base, step);
+}
+#endif
+
+// CHESSTER_SERIALIZE=lut|vbmi2 overrides the CPUID choice.
+static bool pick_vbmi2()
+{
+    if (VBMI2_COMPILED)
+        return true;
+#if defined(CHESSTER_VBMI2_DISPATCH)
+    if (!__builtin_cpu_supports("avx512vbmi2") || !__builtin_cpu_supports("avx512bw"))
+        return false;
+    if (const char* env = std::getenv("CHESSTER_SERIALIZE"))
+        return std::strcmp(env, "lut") != 0;
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char* serialize_backend()
+{
+    return SERIALIZE_USE_VBMI2 ? "vbmi2" : "lut";
+}
+
+namespace {
+struct SerializeInit {
+    SerializeInit()
+    {
+        SERIALIZE_USE_VBMI2 = pick_vbmi2();
+    }
+};
+const SerializeInit g_serialize_init;
+} // namespace
+
+} // namespace engine
@@ -0,0 +1,101 @@
+#pragma once
+#include "bitboard.hh"
+#include "move.hh"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+namespace engine {
+
+// Batch bitboard-to-move serialisation.
+// A target set turns into moves of the form base + sq * step: piece moves use
+// step 64 (from and flag in base, sq is the destination), pawn moves use
+// step 65 so that the origin (sq - push offset) is derived from sq as well.
+// Writers may store up to SERIALIZE_SLACK entries past the last move.
+//
+// Backends, picked like the slider backends in magic.hh:
+//   AVX-512 VBMI2 compiled in (-march=native on such a host): byte compress.
+//   x86-64 otherwise: VBMI2 compress or byte lookup table, by CPUID at startup.
+//   elsewhere: byte lookup table only.
+#if defined(__AVX512VBMI2__) && defined(__AVX512BW__)
+inline constexpr bool VBMI2_COMPILED = true;
+#elif (defined(__GNUG__) || defined(__clang__)) && defined(__x86_64__)
+#define CHESSTER_VBMI2_DISPATCH 1
+inline constexpr bool VBMI2_COMPILED = false;
+#else
+inline constexpr bool VBMI2_COMPILED = false;
+#endif
+
+inline constexpr int SERIALIZE_SLACK = 32;
+
+// true if serialize() uses the VBMI2 compress path (set before any lookup)
+extern bool SERIALIZE_USE_VBMI2;
+
+// "vbmi2" or "lut", for diagnostics
+const char* serialize_backend();
+
+// VBMI2 path; only call when SERIALIZE_USE_VBMI2 is set
+int serialize_vbmi2(Move* out, Bitboard bb, unsigned base, unsigned step);
+
+// set squares of each byte value, in ascending order (16-bit lanes so the
+// eight-wide store below vectorises)
+struct ByteSquares {
+    std::uint16_t sq[8];
+    std::uint16_t count;
+};
+
+inline constexpr std::array<ByteSquares, 256> BYTE_SQUARES = [] {
+    std::array<ByteSquares, 256> t{};
+    for (int v = 0; v < 256; ++v)
+        for (int i = 0; i < 8; ++i)
+            if (v & (1 << i))
+                t[v].sq[t[v].count++] = static_cast<std::uint16_t>(i);
+    return t;
+}();
+
+// Lookup-table path: each non-empty byte writes 8 moves and keeps 'count'.
+inline int serialize_lut(Move* out, Bitboard bb, unsigned base, unsigned step)
+{
+    int n = 0;
+    while (bb) {
+        const int shift = std::countr_zero(bb) & ~7;
+        const ByteSquares& e = BYTE_SQUARES[(bb >> shift) & 0xFF];
+        bb &= ~(0xFFULL << shift);
+
+        const Move rowBase = static_cast<Move>(base + static_cast<unsigned>(shift) * step);
+        const Move rowStep = static_cast<Move>(step);
+        for (int i = 0; i < 8; ++i)
+            out[n + i] = static_cast<Move>(rowBase + e.sq[i] * rowStep);
+        n += e.count;
+    }
+    return n;
+}
+
+// Writes base + sq * step for every square of bb; returns the number written.
+inline int serialize(Move* out, Bitboard bb, unsigned base, unsigned step)
+{
+#if defined(CHESSTER_VBMI2_DISPATCH)
+    if (SERIALIZE_USE_VBMI2)
+        return serialize_vbmi2(out, bb, base, step);
+#else
+    if (VBMI2_COMPILED)
+        return serialize_vbmi2(out, bb, base, step);
+#endif
+    return serialize_lut(out, bb, base, step);
+}
+
+// The four promotions of one pawn move in a single 64-bit store (N, B, R, Q)
+inline void serialize_promotions(Move* out, Move knight)
+{
+    if constexpr (std::endian::native == std::endian::little) {
+        const std::uint64_t four = knight * 0x0001000100010001ULL + 0x3000200010000000ULL;
+        std::memcpy(out, &four, sizeof(four));
+    } else {
+        for (int i = 0; i < 4; ++i)
+            out[i] = static_cast<Move>(knight + (i << 12));
+    }
+}
+
+} // namespace engine
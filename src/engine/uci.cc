@@ -24,7 +24,8 @@ static int move_overhead_ms = 80;
 static bool apply_uci_move(Board& pos, const std::string& uciMove)
 {
     Board tmp = pos;
-    auto legal = generate_legal_moves(tmp);
+    MoveList legal;
+    generate_legal_moves(tmp, legal);
     for (Move m : legal) {
         if (move_to_uci(m) == uciMove) {
             Undo u;
@@ -64,6 +65,10 @@ static void handle_uci_command()
     uci_print_id();
     std::cout << "option name EvalFile type string default (use setoption or CHESSTER_NET/raw.bin)\n";
     std::cout << "option name MoveOverhead type spin default 80 min 0 max 5000\n";
+    std::cout << "option name Threads type spin default 1 min 1 max 256\n";
+    std::cout << "option name Hash type spin default 64 min 1 max 65536\n";
+    std::cout << "option name Clear Hash type button\n";
+    std::cout << "option name SharedHash type string default <empty>\n";
     std::cout << "uciok\n";
 }
 
@@ -84,7 +89,7 @@ static void handle_setoption(const std::string& line)
     std::string w, name, key, value;
     ss >> w;    // setoption
     ss >> w;    // name
-    ss >> name; // EvalFile / MoveOverhead / ...
+    ss >> name; // EvalFile / MoveOverhead / Threads / Hash / Clear (Hash) / SharedHash / ...
     if (name == "EvalFile") {
         ss >> w; // value
         std::getline(ss, value);
@@ -104,6 +109,37 @@ static void handle_setoption(const std::string& line)
         ss >> v;
         if (v >= 0 && v <= 5000)
             move_overhead_ms = v;
+    } else if (name == "Threads") {
+        ss >> w; // value
+        int v = 1;
+        ss >> v;
+        set_threads(v);
+    } else if (name == "Hash") {
+        ss >> w; // value
+        int v = 0;
+        ss >> v;
+        if (v >= 1 && v <= 65536) {
+            tt_resize(static_cast<std::size_t>(v));
+            if (tt_size_mb())
+                std::cout << "info string Hash " << tt_size_mb() << " MB (" << tt_backend() << ")\n";
+            else
+                std::cout << "info string Hash " << v << " MB for SharedHash, mapped at the next search\n";
+        }
+    } else if (name == "SharedHash") {
+        ss >> w; // value
+        value.clear();
+        ss >> value;
+        if (value == "<empty>")
+            value.clear();
+        tt_set_shared(value);
+        if (value.empty())
+            std::cout << "info string SharedHash off\n";
+        else
+            std::cout << "info string SharedHash " << value << ", mapped at the next search\n";
+    } else if (name == "Clear") {
+        ss >> w; // "Clear Hash" is a button, no value
+        if (w == "Hash")
+            tt_clear();
     }
 }
 
@@ -259,7 +295,8 @@ static void handle_go(const std::string& line, const Board& pos)
         bm = search_best_move(tmp, maxDepth > 0 ? maxDepth : 12);
 
     if (!bm) {
-        auto v = generate_legal_moves(tmp);
+        MoveList v;
+        generate_legal_moves(tmp, v);
         if (!v.empty())
             bm = v[0];
     }
@@ -305,7 +342,9 @@ int main()
 
         if (line.rfind("ucinewgame", 0) == 0) {
             pos = Board::startpos();
-            engine::tt_clear();
+            // a shared table holds other processes' work; only Clear Hash wipes it
+            if (!engine::tt_is_shared())
+                engine::tt_clear();
             continue;
         }
 
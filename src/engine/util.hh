@@ -106,26 +106,21 @@ static inline int pop_lsb(std::uint64_t& b)
 
 static inline bool in_check(const Board& b)
 {
-    const Colour us = b.side_to_move;
-    const Colour them = (us == WHITE ? BLACK : WHITE);
-    int ksq = king_sq(b, us);
-    return ksq >= 0 && is_square_attacked(b, ksq, them);
+    return b.st.checkers != 0ULL;
 }
 
 static inline bool is_checkmate(Board& b)
 {
     if (!in_check(b))
         return false;
-    auto moves = generate_legal_moves(b);
-    return moves.empty();
+    return count_legal_moves(b) == 0;
 }
 
 static inline bool is_stalemate(Board& b)
 {
     if (in_check(b))
         return false;
-    auto moves = generate_legal_moves(b);
-    return moves.empty();
+    return count_legal_moves(b) == 0;
 }
 
 inline std::string move_to_uci(Move m)
@@ -168,13 +163,11 @@ inline Piece promo_piece_from_flag(int fl)
     }
 }
 
+// mailbox lookup; the bitboard test filters out the other colour's piece
 inline Piece piece_on(const Board& b, Colour c, int sq)
 {
-    Bitboard mask = (1ULL << sq);
-    for (int p = PAWN; p <= KING; ++p)
-        if (b.pieces[c][p] & mask)
-            return static_cast<Piece>(p);
-    return NO_PIECE;
+    const Piece p = b.squares[sq];
+    return (p != NO_PIECE && (b.pieces[c][p] & (1ULL << sq))) ? p : NO_PIECE;
 }
 
 } // namespace engine
\ No newline at end of file
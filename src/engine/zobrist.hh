@@ -1,4 +1,5 @@
 #pragma once
+#include "attack_tables.hh"
 #include "board.hh"
 
 #include <cstdint>
@@ -9,27 +10,106 @@ struct Board;
 
 namespace zobrist {
 
-// one time init
-void init();
+// Key tables, filled by SplitMix64 from a fixed seed at compile time, so the
+// accessors below are plain loads with no init check.
+struct Keys {
+    std::uint64_t psq[2][6][64]; // colour, piece, square
+    std::uint64_t side;
+    std::uint64_t castle[16]; // indexed by the castling mask
+    std::uint64_t epFile[8];
+};
+
+// SplitMix64: deterministic generator for table fill
+constexpr std::uint64_t splitmix64(std::uint64_t& x)
+{
+    std::uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr Keys make_keys()
+{
+    Keys k{};
+    std::uint64_t seed = 0xC0FFEE5EED5BADULL; // fixed seed for reproducibility
+    for (int c = 0; c < 2; ++c)
+        for (int p = 0; p < 6; ++p)
+            for (int s = 0; s < 64; ++s)
+                k.psq[c][p][s] = splitmix64(seed);
+
+    k.side = splitmix64(seed);
+
+    // one key per right; each mask's key is the XOR of its rights' keys
+    for (int r = 0; r < 4; ++r)
+        k.castle[1 << r] = splitmix64(seed);
+    for (int m = 1; m < 16; ++m)
+        k.castle[m] = k.castle[m & -m] ^ k.castle[m & (m - 1)];
+
+    for (int f = 0; f < 8; ++f)
+        k.epFile[f] = splitmix64(seed);
+    return k;
+}
+
+inline constexpr Keys KEYS = make_keys();
 
 // full recompute from board state
 std::uint64_t compute(const Board& b);
 
+// Pawn key: psq of the pawns alone, for pawn-structure caches.
+std::uint64_t compute_pawn(const Board& b);
+
+// Material key: piece counts only, XOR of psq[c][p][i] for i < count of
+// (c, p), so adding the n-th piece of a kind toggles psq[c][p][n - 1].
+std::uint64_t compute_material(const Board& b);
+
+// Material key of a piece count table, e.g. for material-table lookups
+constexpr std::uint64_t material_of(const int (&counts)[2][6])
+{
+    std::uint64_t k = 0;
+    for (int c = 0; c < 2; ++c)
+        for (int p = 0; p < 6; ++p)
+            for (int i = 0; i < counts[c][p]; ++i)
+                k ^= KEYS.psq[c][p][i];
+    return k;
+}
+
 // incremental helpers (used by make/unmake move)
 // piece-square key
-std::uint64_t psq(Colour c, Piece p, int sq);
+inline std::uint64_t psq(Colour c, Piece p, int sq)
+{
+    return KEYS.psq[c][p][sq];
+}
 
 // STM
-std::uint64_t side();
+inline std::uint64_t side()
+{
+    return KEYS.side;
+}
 
-// XOR of all activate castling rights
-std::uint64_t castle_mask(const CastlingRights&);
+// XOR of all active castling rights (CastlingRight bits)
+inline std::uint64_t castle_mask(unsigned rights)
+{
+    return KEYS.castle[rights & 15];
+}
 
 // EP file
-std::uint64_t ep_file(int file);
+inline std::uint64_t ep_file(int file)
+{
+    return KEYS.epFile[file & 7];
+}
 
 // EP component hashed only if an EP capture is actually possibly by STM
-std::uint64_t ep_component(const Board& b, Colour stm);
+inline std::uint64_t ep_component(const Board& b, Colour stm)
+{
+    if (b.ep_square == SQ_NONE)
+        return 0ULL;
+    const int eps = b.ep_square;
+
+    // stm's pawns attack eps from where an opposing pawn on eps would attack
+    if (PAWN_ATTACKS[stm ^ 1][eps] & b.pieces[stm][PAWN])
+        return KEYS.epFile[eps & 7];
+    return 0ULL;
+}
 
 } // namespace zobrist
-} // namespace engine
\ No newline at end of file
+} // namespace engine
@@ -1,7 +1,9 @@
 #pragma once
 #include "../src/engine/board.hh"
 
+#include <cstddef>
 #include <cstdint>
+#include <new>
 #include <vector>
 
 namespace eval {
@@ -48,6 +50,32 @@ void revert(EvalState& st, const NNUEDelta& delta);
 int evaluate(const engine::Board&); // builds a temp state then calls evaluate(state)
 void debug_dump(const engine::Board& b);
 
+// Allocator for the accumulators: cache-line aligned so update/revert speed
+// does not depend on where the heap places them, and so EvalStates owned by
+// different search threads never share a line.
+template <class T> struct CacheAligned {
+    using value_type = T;
+    static constexpr std::align_val_t ALIGN{64};
+
+    CacheAligned() = default;
+    template <class U> CacheAligned(const CacheAligned<U>&) {}
+
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(::operator new(n * sizeof(T), ALIGN));
+    }
+    void deallocate(T* p, std::size_t)
+    {
+        ::operator delete(p, ALIGN);
+    }
+    template <class U> bool operator==(const CacheAligned<U>&) const
+    {
+        return true;
+    }
+};
+
+template <class T> using AccVector = std::vector<T, CacheAligned<T>>;
+
 struct EvalState {
     // model shape / path flag
     int H{0};
@@ -58,8 +86,8 @@ struct EvalState {
     // Reference orientation accumulators
     // accW = ref=WHITE, preactivation vector (bias + sum(feature columns))
     // accB = ref=BLACK, preactivation vector (bias + sum(feature columns))
-    std::vector<int32_t> accW_q, accB_q; // quantised path
-    std::vector<float> accW_f, accB_f;   // float path
+    AccVector<int32_t> accW_q, accB_q; // quantised path
+    AccVector<float> accW_f, accB_f;   // float path
 };
 
 } // namespace eval
@@ -321,19 +321,15 @@ int evaluate(const EvalState& st)
     const bool stmWhite = (st.stm == (uint8_t)engine::WHITE);
 
     if (IS_Q) {
-        std::vector<int32_t> a_stm = stmWhite ? st.accW_q : st.accB_q;
-        std::vector<int32_t> a_ntm = stmWhite ? st.accB_q : st.accW_q;
-
-        for (int i = 0; i < H; ++i) {
-            a_stm[i] = screlu_i16(a_stm[i]);
-            a_ntm[i] = screlu_i16(a_ntm[i]);
-        }
+        const AccVector<int32_t>& a_stm = stmWhite ? st.accW_q : st.accB_q;
+        const AccVector<int32_t>& a_ntm = stmWhite ? st.accB_q : st.accW_q;
 
+        // activation applied on the fly; the accumulators are left untouched
         long long out = 0;
         for (int i = 0; i < H; ++i)
-            out += (long long)a_stm[i] * (long long)L1W_q[i];
+            out += (long long)screlu_i16(a_stm[i]) * (long long)L1W_q[i];
         for (int i = 0; i < H; ++i)
-            out += (long long)a_ntm[i] * (long long)L1W_q[H + i];
+            out += (long long)screlu_i16(a_ntm[i]) * (long long)L1W_q[H + i];
 
         out /= QA;
         out += (long long)L1B_q;
@@ -347,25 +343,20 @@ int evaluate(const EvalState& st)
 
         return (int)out;
     } else {
-        std::vector<float> a_stm = stmWhite ? st.accW_f : st.accB_f;
-        std::vector<float> a_ntm = stmWhite ? st.accB_f : st.accW_f;
-
-        for (int i = 0; i < H; ++i) {
-            a_stm[i] = screlu_float(a_stm[i]);
-            a_ntm[i] = screlu_float(a_ntm[i]);
-        }
+        const AccVector<float>& a_stm = stmWhite ? st.accW_f : st.accB_f;
+        const AccVector<float>& a_ntm = stmWhite ? st.accB_f : st.accW_f;
 
         float y = L1Bf;
         for (int i = 0; i < H; ++i)
-            y += L1Wf[i] * a_stm[i];
+            y += L1Wf[i] * screlu_float(a_stm[i]);
         for (int i = 0; i < H; ++i)
-            y += L1Wf[H + i] * a_ntm[i];
+            y += L1Wf[H + i] * screlu_float(a_ntm[i]);
 
         return to_centipawns(y);
     }
 }
 
-static inline void apply_col_q(std::vector<int32_t>& acc, const int16_t* col, int sign)
+static inline void apply_col_q(AccVector<int32_t>& acc, const int16_t* col, int sign)
 {
     if (sign == 1)
         for (int i = 0; i < H; ++i)
@@ -375,7 +366,7 @@ static inline void apply_col_q(std::vector<int32_t>& acc, const int16_t* col, in
             acc[i] -= (int32_t)col[i];
 }
 
-static inline void apply_col_f(std::vector<float>& acc, const float* col, int sign)
+static inline void apply_col_f(AccVector<float>& acc, const float* col, int sign)
 {
     if (sign == 1)
         for (int i = 0; i < H; ++i)
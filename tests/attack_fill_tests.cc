@@ -0,0 +1,65 @@
+#include "attack_fill.hh"
+#include "bitboard.hh"
+#include "board.hh"
+#include "fen.hh"
+#include "magic.hh"
+#include "move_do.hh"
+#include "util.hh"
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+
+using namespace engine;
+
+// Union of the magic lookups for every slider, the per-piece reference
+static Bitboard magic_union(Bitboard rq, Bitboard bq, Bitboard occ)
+{
+    Bitboard att = 0ULL;
+    while (rq)
+        att |= rook_attacks(pop_lsb(rq), occ);
+    while (bq)
+        att |= bishop_attacks(pop_lsb(bq), occ);
+    return att;
+}
+
+TEST_CASE("Kogge-Stone fill matches per-piece magic lookups")
+{
+    // rays run to the edge without wrapping onto the next rank
+    REQUIRE(slider_fill_scalar(1ULL << H1, 0ULL, 1ULL << H1) == rook_attacks(H1, 0ULL));
+    REQUIRE(slider_fill_scalar(0ULL, 1ULL << A4, 1ULL << A4) == bishop_attacks(A4, 0ULL));
+
+    const bool avx2 = fill_avx2();
+
+    std::uint64_t seed = 0x0F1E2D3C4B5A6978ULL;
+    for (int i = 0; i < 2000; ++i) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        const Bitboard occ = seed & (seed >> 9);
+        const Bitboard rq = occ & (seed >> 23) & (seed >> 31);
+        const Bitboard bq = occ & (seed >> 37) & (seed >> 41);
+
+        const Bitboard expect = magic_union(rq, bq, occ);
+        REQUIRE(slider_fill_scalar(rq, bq, occ) == expect);
+        if (avx2)
+            REQUIRE(slider_fill_avx2(rq, bq, occ) == expect);
+    }
+}
+
+TEST_CASE("Attack map agrees with square-by-square attack tests")
+{
+    const char* fens[] = {
+            "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+            "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    };
+    for (const char* fen : fens) {
+        const Board b = from_fen(fen);
+        for (Colour by : {WHITE, BLACK}) {
+            const Bitboard map = attacked_squares(b, by, occupancy(b));
+            for (int sq = 0; sq < 64; ++sq)
+                REQUIRE(((map >> sq) & 1ULL) == static_cast<Bitboard>(is_square_attacked(b, sq, by)));
+        }
+    }
+}
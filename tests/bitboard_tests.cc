@@ -1,3 +1,4 @@
+#include "attack_tables.hh"
 #include "bitboard.hh"
 
 #include <catch2/catch_test_macros.hpp>
@@ -36,3 +37,40 @@ TEST_CASE("north/east masks")
     REQUIRE(north(0x1ULL) == 0x100ULL);
     REQUIRE(east(0x0101010101010101ULL) == 0x0202020202020202ULL);
 }
+
+TEST_CASE("Compile-time attack tables")
+{
+    SECTION("Leapers")
+    {
+        static_assert(KNIGHT_ATTACKS[A1] == ((1ULL << B3) | (1ULL << C2)));
+        static_assert(KING_ATTACKS[A1] == ((1ULL << A2) | (1ULL << B1) | (1ULL << B2)));
+        REQUIRE(__builtin_popcountll(KNIGHT_ATTACKS[D4]) == 8);
+        REQUIRE(__builtin_popcountll(KING_ATTACKS[E4]) == 8);
+        REQUIRE(__builtin_popcountll(KING_ATTACKS[H8]) == 3);
+    }
+
+    SECTION("Pawns attack diagonally forward")
+    {
+        REQUIRE(PAWN_ATTACKS[0][E4] == ((1ULL << D5) | (1ULL << F5)));
+        REQUIRE(PAWN_ATTACKS[1][E4] == ((1ULL << D3) | (1ULL << F3)));
+        REQUIRE(PAWN_ATTACKS[0][A2] == (1ULL << B3));
+        REQUIRE(PAWN_ATTACKS[1][H7] == (1ULL << G6));
+    }
+
+    SECTION("Between and line")
+    {
+        REQUIRE(BETWEEN[A1][D4] == ((1ULL << B2) | (1ULL << C3)));
+        REQUIRE(BETWEEN[A1][B3] == 0ULL);
+        REQUIRE(BETWEEN[E1][E2] == 0ULL);
+        REQUIRE(LINE[B2][C3] == 0x8040201008040201ULL);
+        REQUIRE(LINE[A1][B3] == 0ULL);
+        REQUIRE(LINE[E1][E5] == FileBB[4]);
+    }
+
+    SECTION("Distance")
+    {
+        REQUIRE(DISTANCE[A1][H8] == 7);
+        REQUIRE(DISTANCE[E4][F6] == 2);
+        REQUIRE(DISTANCE[C3][C3] == 0);
+    }
+}
@@ -0,0 +1,55 @@
+#include "bitboard.hh"
+#include "magic.hh"
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+
+using namespace engine;
+
+// Step-by-step ray walk used as the reference for the magic lookups
+static Bitboard slow_attacks(int sq, Bitboard occ, Bitboard (*const steps[4])(Bitboard))
+{
+    Bitboard att = 0ULL;
+    for (int i = 0; i < 4; ++i) {
+        Bitboard r = 1ULL << sq;
+        while ((r = steps[i](r))) {
+            att |= r;
+            if (r & occ)
+                break;
+        }
+    }
+    return att;
+}
+
+TEST_CASE("Slider attacks on an empty board")
+{
+    REQUIRE(rook_attacks(A1, 0ULL) == ((FileBB[0] | RankBB[0]) & ~(1ULL << A1)));
+    REQUIRE(bishop_attacks(A1, 0ULL) == 0x8040201008040200ULL);
+    REQUIRE(queen_attacks(D4, 0ULL) == (rook_attacks(D4, 0ULL) | bishop_attacks(D4, 0ULL)));
+}
+
+TEST_CASE("Slider attacks stop at the first blocker")
+{
+    // Rook a1 with a blocker on a4: a2, a3, a4 and the whole first rank
+    const Bitboard occ = 1ULL << A4;
+    REQUIRE(rook_attacks(A1, occ) == ((1ULL << A2) | (1ULL << A3) | (1ULL << A4) | (RankBB[0] & ~(1ULL << A1))));
+}
+
+TEST_CASE("Magic lookups match a ray walk for random occupancies")
+{
+    Bitboard (*const rookSteps[4])(Bitboard) = {&north, &south, &east, &west};
+    Bitboard (*const bishopSteps[4])(Bitboard) = {&ne, &nw, &se, &sw};
+
+    std::uint64_t seed = 0x123456789ABCDEFULL;
+    for (int i = 0; i < 2000; ++i) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        const Bitboard occ = seed & (seed >> 9); // roughly a quarter of the board occupied
+
+        for (int sq = 0; sq < 64; ++sq) {
+            REQUIRE(rook_attacks(sq, occ) == slow_attacks(sq, occ, rookSteps));
+            REQUIRE(bishop_attacks(sq, occ) == slow_attacks(sq, occ, bishopSteps));
+        }
+    }
+}
@@ -3,6 +3,7 @@
 #include "move_do.hh"
 #include "movegen.hh"
 #include "perft.hh"
+#include "zobrist.hh"
 
 #include <algorithm>
 #include <catch2/catch_test_macros.hpp>
@@ -96,3 +97,278 @@ TEST_CASE("Make/Unmake roundtrip restores exact FEN")
         REQUIRE(to_fen(b) == start);
     }
 }
+
+// the mailbox and cached occupancy match the piece bitboards
+static bool mailbox_in_sync(const Board& b)
+{
+    for (int c = WHITE; c <= BLACK; ++c) {
+        Bitboard occ = 0;
+        for (int p = PAWN; p <= KING; ++p)
+            occ |= b.pieces[c][p];
+        if (b.by_colour[c] != occ)
+            return false;
+    }
+    if (b.occupied != (b.by_colour[WHITE] | b.by_colour[BLACK]))
+        return false;
+
+    for (int sq = 0; sq < 64; ++sq) {
+        Piece expected = NO_PIECE;
+        for (int c = WHITE; c <= BLACK; ++c)
+            for (int p = PAWN; p <= KING; ++p)
+                if (b.pieces[c][p] & (1ULL << sq))
+                    expected = static_cast<Piece>(p);
+        if (b.squares[sq] != expected)
+            return false;
+    }
+    return true;
+}
+
+TEST_CASE("Mailbox and occupancy stay in sync through make/unmake")
+{
+    // castling, en passant and promotions (with and without capture) all occur one ply deep
+    Board root = from_fen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    REQUIRE(mailbox_in_sync(root));
+    REQUIRE(mailbox_in_sync(Board::startpos()));
+
+    for (Move first : generate_legal_moves(root)) {
+        Board b = root;
+        Undo ur;
+        make_move(b, first, ur);
+        REQUIRE(mailbox_in_sync(b));
+
+        for (Move m : generate_legal_moves(b)) {
+            Undo u;
+            make_move(b, m, u);
+            REQUIRE(mailbox_in_sync(b));
+            unmake_move(b, m, u);
+        }
+        unmake_move(b, first, ur);
+        REQUIRE(b.squares == root.squares);
+    }
+}
+
+static bool same_check_info(const StateInfo& a, const StateInfo& b)
+{
+    return a.checkers == b.checkers && std::equal(a.blockers, a.blockers + 2, b.blockers) &&
+           std::equal(a.check_squares, a.check_squares + 6, b.check_squares);
+}
+
+TEST_CASE("Cached check info matches a fresh computation after make/unmake")
+{
+    const char* fens[] = {
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    };
+
+    for (const char* fen : fens) {
+        Board root = from_fen(fen);
+        for (Move first : generate_legal_moves(root)) {
+            Board b = root;
+            Undo ur;
+            make_move(b, first, ur);
+
+            Board fresh = b;
+            set_check_info(fresh);
+            REQUIRE(same_check_info(b.st, fresh.st));
+
+            const int ksq = __builtin_ctzll(b.pieces[b.side_to_move][KING]);
+            REQUIRE((b.st.checkers != 0) == is_square_attacked(b, ksq, root.side_to_move));
+
+            unmake_move(b, first, ur);
+            REQUIRE(same_check_info(b.st, root.st));
+        }
+    }
+}
+
+TEST_CASE("gives_check agrees with making the move")
+{
+    const char* fens[] = {
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+            "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+            "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+            "8/8/8/k2Pp2R/8/8/8/4K3 w - e6 0 1", // en passant uncovers the rook
+            "8/8/8/8/8/8/8/R3K2k w Q - 0 1",     // O-O-O checks along the first rank
+    };
+
+    for (const char* fen : fens) {
+        Board root = from_fen(fen);
+        for (Move first : generate_legal_moves(root)) {
+            Board b = root;
+            Undo ur;
+            make_move(b, first, ur);
+
+            for (Move m : generate_legal_moves(b)) {
+                Board after = b;
+                Undo u;
+                make_move(after, m, u);
+                REQUIRE(gives_check(b, m) == (after.st.checkers != 0));
+            }
+        }
+
+        for (Move m : generate_legal_moves(root)) {
+            Board after = root;
+            Undo u;
+            make_move(after, m, u);
+            REQUIRE(gives_check(root, m) == (after.st.checkers != 0));
+        }
+    }
+}
+
+TEST_CASE("Copy-make matches make_move and leaves the parent untouched")
+{
+    Board root = from_fen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    const std::string start = to_fen(root);
+
+    for (Move m : generate_legal_moves(root)) {
+        Board child;
+        Undo uc;
+        copy_make(root, child, m, uc);
+
+        Board b = root;
+        Undo u;
+        make_move(b, m, u);
+
+        REQUIRE(to_fen(child) == to_fen(b));
+        REQUIRE(child.zkey() == b.zkey());
+        REQUIRE(to_fen(root) == start);
+    }
+}
+
+static bool keys_match(const Board& b)
+{
+    return b.zkey() == zobrist::compute(b) && b.pawn_key() == zobrist::compute_pawn(b) &&
+           b.material_key() == zobrist::compute_material(b);
+}
+
+TEST_CASE("Incremental and predicted Zobrist keys match a full recompute")
+{
+    static_assert(zobrist::KEYS.castle[WHITE_OO | BLACK_OOO] ==
+                  (zobrist::KEYS.castle[WHITE_OO] ^ zobrist::KEYS.castle[BLACK_OOO]));
+
+    const char* fens[] = {
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+            "8/8/8/k2Pp2R/8/8/8/4K3 w - e6 0 1",
+            "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1", // promotions with and without capture
+    };
+
+    for (const char* fen : fens) {
+        Board root = from_fen(fen);
+        for (Move first : generate_legal_moves(root)) {
+            Board b = root;
+            Undo u1;
+            make_move(b, first, u1);
+            REQUIRE(keys_match(b));
+            REQUIRE(b.zkey() == key_after(root, first));
+            for (Move m : generate_legal_moves(b)) {
+                const std::uint64_t predicted = key_after(b, m);
+                Undo u2;
+                make_move(b, m, u2);
+                REQUIRE(keys_match(b));
+                REQUIRE(b.zkey() == predicted);
+                unmake_move(b, m, u2);
+            }
+            unmake_move(b, first, u1);
+            REQUIRE(b.zkey() == root.zkey());
+            REQUIRE(b.pawn_key() == root.pawn_key());
+            REQUIRE(b.material_key() == root.material_key());
+        }
+    }
+}
+
+TEST_CASE("Insufficient material is read from the material key")
+{
+    REQUIRE(trivial_insufficient_material(from_fen("8/8/4k3/8/8/3K4/8/8 w - - 0 1")));
+    REQUIRE(trivial_insufficient_material(from_fen("8/8/4k3/8/8/3KN3/8/8 w - - 0 1")));
+    REQUIRE(trivial_insufficient_material(from_fen("8/8/4kb2/8/8/3K4/8/8 w - - 0 1")));
+    REQUIRE(!trivial_insufficient_material(from_fen("8/8/4kb2/8/8/3KN3/8/8 w - - 0 1")));
+    REQUIRE(!trivial_insufficient_material(from_fen("8/8/4k3/8/8/3KNN2/8/8 w - - 0 1")));
+    REQUIRE(!trivial_insufficient_material(from_fen("8/8/4k3/8/8/3KP3/8/8 w - - 0 1")));
+
+    // capturing the last rook leaves bare kings
+    Board b = from_fen("8/8/8/3Rk3/8/3K4/8/8 b - - 0 1");
+    REQUIRE(!trivial_insufficient_material(b));
+    Undo u;
+    make_move(b, make_move(E5, D5, CAPTURE), u);
+    REQUIRE(trivial_insufficient_material(b));
+}
+
+TEST_CASE("Castling rights drop when king or rook leaves or a rook is captured")
+{
+    Board b = from_fen("r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1");
+
+    Undo u1;
+    make_move(b, make_move(A1, A8, CAPTURE), u1);
+    REQUIRE(b.castle == (WHITE_OO | BLACK_OO));
+
+    Undo u2;
+    make_move(b, make_move(E8, F8, QUIET), u2);
+    REQUIRE(b.castle == WHITE_OO);
+
+    unmake_move(b, make_move(E8, F8, QUIET), u2);
+    unmake_move(b, make_move(A1, A8, CAPTURE), u1);
+    REQUIRE(b.castle == ALL_CASTLING);
+}
+
+TEST_CASE("Legal generator agrees with make/unmake filtering of pseudo-legal moves")
+{
+    const char* fens[] = {
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+            "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+            "8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1",
+    };
+
+    // all positions one ply deep from each root
+    for (const char* fen : fens) {
+        Board root = from_fen(fen);
+        for (Move first : generate_legal_moves(root)) {
+            Board b = root;
+            Undo ur;
+            make_move(b, first, ur);
+
+            const Colour us = b.side_to_move;
+            const Colour them = (us == WHITE) ? BLACK : WHITE;
+
+            std::vector<Move> expected;
+            for (Move m : generate_moves(b)) {
+                Undo u;
+                make_move(b, m, u);
+                const int ksq = __builtin_ctzll(b.pieces[us][KING]);
+                if (!is_square_attacked(b, ksq, them))
+                    expected.push_back(m);
+                unmake_move(b, m, u);
+            }
+
+            auto legal = generate_legal_moves(b);
+            std::sort(expected.begin(), expected.end());
+            std::sort(legal.begin(), legal.end());
+            REQUIRE(legal == expected);
+        }
+    }
+}
+
+TEST_CASE("count_legal_moves matches the generated list")
+{
+    const char* fens[] = {
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+            "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+            "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+            "8/8/8/k2Pp2R/8/8/8/4K3 w - e6 0 1",
+            "8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1",
+    };
+
+    for (const char* fen : fens) {
+        Board root = from_fen(fen);
+        REQUIRE(count_legal_moves(root) == static_cast<int>(generate_legal_moves(root).size()));
+        for (Move first : generate_legal_moves(root)) {
+            Board b = root;
+            Undo u;
+            make_move(b, first, u);
+            REQUIRE(count_legal_moves(b) == static_cast<int>(generate_legal_moves(b).size()));
+            unmake_move(b, first, u);
+        }
+    }
+}
@@ -4,6 +4,8 @@
 
 #include <catch2/catch_test_macros.hpp>
 
+#include <algorithm>
+
 using namespace engine;
 
 static std::size_t count_flag(const std::vector<Move>& ms, int f)
@@ -127,3 +129,61 @@ TEST_CASE("Black castling both sides when clear and not attacked")
     REQUIRE(std::count_if(ms.begin(), ms.end(),
                           [](engine::Move m) { return engine::flag(m) == engine::QUEEN_CASTLE; }) == 1);
 }
+
+TEST_CASE("Capture and quiet generators split the legal moves")
+{
+    Board b = from_fen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+
+    MoveList caps, quiets;
+    generate<CAPTURES>(b, caps);
+    generate<QUIETS>(b, quiets);
+
+    REQUIRE(caps.size() == 8);
+    REQUIRE(caps.size() + quiets.size() == 48);
+    REQUIRE(std::all_of(caps.begin(), caps.end(), [](Move m) { return is_capture(m); }));
+    REQUIRE(std::none_of(quiets.begin(), quiets.end(), [](Move m) { return is_capture(m); }));
+}
+
+TEST_CASE("Promotions are generated with the captures")
+{
+    // a7 pawn can promote by push or by capturing on b8
+    Board b = from_fen("1r2k3/P7/8/8/8/8/8/4K3 w - - 0 1");
+
+    MoveList caps, quiets;
+    generate<CAPTURES>(b, caps);
+    generate<QUIETS>(b, quiets);
+
+    REQUIRE(caps.size() == 8);
+    REQUIRE(std::none_of(quiets.begin(), quiets.end(), [](Move m) { return flag(m) >= PROMO_N; }));
+}
+
+TEST_CASE("Evasions out of check")
+{
+    // Black queen checks from e2; the king can only take it
+    Board b = from_fen("4k3/8/8/8/8/8/4q3/4K3 w - - 0 1");
+
+    MoveList ev;
+    generate<EVASIONS>(b, ev);
+    REQUIRE(ev.size() == 1);
+    REQUIRE(ev[0] == make_move(E1, E2, CAPTURE));
+}
+
+TEST_CASE("Quiet checks: direct, discovered and castling")
+{
+    // Rook d1 checks from d7, bishop c2 uncovers the queen b1 on the diagonal to h7
+    Board b = from_fen("8/7k/8/8/8/8/2B5/1Q1RK3 w - - 0 1");
+
+    MoveList qc;
+    generate<QUIET_CHECKS>(b, qc);
+
+    auto has = [&](Move m) { return std::find(qc.begin(), qc.end(), m) != qc.end(); };
+    REQUIRE(has(make_move(D1, D7, QUIET)));
+    REQUIRE(has(make_move(C2, B3, QUIET)));
+    REQUIRE(!has(make_move(D1, D2, QUIET)));
+
+    // O-O lands the rook on f1, facing the king on f8
+    Board c = from_fen("5k2/8/8/8/8/8/8/4K2R w K - 0 1");
+    MoveList cc;
+    generate<QUIET_CHECKS>(c, cc);
+    REQUIRE(std::find(cc.begin(), cc.end(), make_move(E1, G1, KING_CASTLE)) != cc.end());
+}
@@ -164,3 +164,40 @@ TEST_CASE("Perft tricky artificial positions (final count only)")
         }
     }
 }
+
+TEST_CASE("Parallel perft matches the serial counts")
+{
+    const char* fens[] = {
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+            "8/5bk1/8/2Pp4/8/1K6/8/8 w - d6 0 1",
+    };
+    for (const char* fen : fens) {
+        Board b = from_fen(fen);
+        const auto serial = perft_divide(b, 4);
+        for (int threads : {1, 4, 0}) {
+            REQUIRE(perft_divide(b, 4, threads) == serial);
+            REQUIRE(perft(b, 4, threads) == perft(b, 4));
+        }
+        REQUIRE(perft(b, 2, 4) == perft(b, 2));
+    }
+}
+
+TEST_CASE("Hashed perft matches the serial counts")
+{
+    const char* fens[] = {
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+            "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    };
+    // a tiny table so entries are overwritten constantly
+    PerftTable tt(1);
+    for (const char* fen : fens) {
+        Board b = from_fen(fen);
+        const std::uint64_t serial = perft(b, 4);
+        tt.clear();
+        REQUIRE(perft(b, 4, tt) == serial);
+        REQUIRE(perft(b, 4, tt) == serial); // second run is served from the table
+        REQUIRE(perft(b, 4, 4, &tt) == serial);
+    }
+}
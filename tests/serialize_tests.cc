@@ -0,0 +1,79 @@
+#include "bitboard.hh"
+#include "move.hh"
+#include "serialize.hh"
+#include "util.hh"
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <vector>
+
+using namespace engine;
+
+// One move per set bit, lowest square first, as the pop_lsb loops produce
+static std::vector<Move> slow_serialize(Bitboard bb, unsigned base, unsigned step)
+{
+    std::vector<Move> out;
+    while (bb) {
+        const int sq = pop_lsb(bb);
+        out.push_back(static_cast<Move>(base + sq * step));
+    }
+    return out;
+}
+
+static std::vector<Move> run(int (*fn)(Move*, Bitboard, unsigned, unsigned), Bitboard bb, unsigned base, unsigned step)
+{
+    Move buf[64 + SERIALIZE_SLACK];
+    const int n = fn(buf, bb, base, step);
+    return std::vector<Move>(buf, buf + n);
+}
+
+TEST_CASE("Batch serialisation matches a pop_lsb loop")
+{
+    const bool vbmi2 = SERIALIZE_USE_VBMI2;
+
+    std::uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < 2000; ++i) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        const Bitboard bb = (i & 1) ? seed : (seed & (seed >> 11));
+
+        // piece moves from e4, and black pawn pushes (from = to + 8)
+        const unsigned pieceBase = make_move(E4, 0, CAPTURE);
+        const unsigned pawnBase = (static_cast<unsigned>(QUIET) << 12) + 8;
+        const Bitboard pawnTos = bb & ~RankBB[7];
+
+        REQUIRE(run(serialize_lut, bb, pieceBase, 64) == slow_serialize(bb, pieceBase, 64));
+        REQUIRE(run(serialize_lut, pawnTos, pawnBase, 65) == slow_serialize(pawnTos, pawnBase, 65));
+        if (vbmi2) {
+            REQUIRE(run(serialize_vbmi2, bb, pieceBase, 64) == slow_serialize(bb, pieceBase, 64));
+            REQUIRE(run(serialize_vbmi2, pawnTos, pawnBase, 65) == slow_serialize(pawnTos, pawnBase, 65));
+        }
+    }
+
+    REQUIRE(run(serialize, 0ULL, 0, 64).empty());
+    REQUIRE(run(serialize, ~0ULL, 0, 64).size() == 64);
+}
+
+TEST_CASE("Pawn serialisation recovers the origin square")
+{
+    // white pushes to the fourth rank from the second (double push, from = to - 16)
+    Move buf[64 + SERIALIZE_SLACK];
+    const int n = serialize(buf, RankBB[3], (static_cast<unsigned>(DOUBLE_PUSH) << 12) - 16, 65);
+    REQUIRE(n == 8);
+    for (int i = 0; i < n; ++i) {
+        REQUIRE(from_sq(buf[i]) == A2 + i);
+        REQUIRE(to_sq(buf[i]) == A4 + i);
+        REQUIRE(flag(buf[i]) == DOUBLE_PUSH);
+    }
+}
+
+TEST_CASE("Promotions are written as one block")
+{
+    Move buf[4];
+    serialize_promotions(buf, make_move(B7, A8, PROMO_N_CAPTURE));
+    REQUIRE(buf[0] == make_move(B7, A8, PROMO_N_CAPTURE));
+    REQUIRE(buf[1] == make_move(B7, A8, PROMO_B_CAPTURE));
+    REQUIRE(buf[2] == make_move(B7, A8, PROMO_R_CAPTURE));
+    REQUIRE(buf[3] == make_move(B7, A8, PROMO_Q_CAPTURE));
+}
@@ -0,0 +1,137 @@
+// tools/bench_make.cc
+#include "engine/board.hh"
+#include "engine/fen.hh"
+#include "engine/move.hh"
+#include "engine/move_do.hh"
+#include "engine/movegen.hh"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace engine;
+
+// Full tree walks (every leaf is made, no bulk counting) so the cost of
+// applying and taking back moves dominates.
+struct BenchPos {
+    const char* fen;
+    int depth;
+};
+
+static constexpr BenchPos SUITE[] = {
+        {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5},
+        {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4},
+        {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5},
+        {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4},
+        {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4},
+};
+
+static void usage(const char* argv0)
+{
+    std::cerr << "Usage:\n"
+                 "  "
+              << argv0
+              << " [--depth D] [--loops L]\n"
+                 "\n"
+                 "Notes:\n"
+                 "  Walks a fixed perft suite with make/unmake and with copy-make.\n"
+                 "  --depth overrides the per-position depth of the built-in suite.\n";
+}
+
+static std::uint64_t walk_unmake(Board& b, int depth)
+{
+    if (depth == 0)
+        return 1;
+
+    MoveList moves;
+    generate_legal_moves(b, moves);
+
+    std::uint64_t nodes = 0;
+    for (Move m : moves) {
+        Undo u;
+        make_move(b, m, u);
+        nodes += walk_unmake(b, depth - 1);
+        unmake_move(b, m, u);
+    }
+    return nodes;
+}
+
+static std::uint64_t walk_copy(const Board& b, int depth)
+{
+    if (depth == 0)
+        return 1;
+
+    MoveList moves;
+    generate_legal_moves(b, moves);
+
+    std::uint64_t nodes = 0;
+    for (Move m : moves) {
+        Undo u;
+        Board child;
+        copy_make(b, child, m, u);
+        nodes += walk_copy(child, depth - 1);
+    }
+    return nodes;
+}
+
+template <typename Walk> static void run(const char* mode, int depthOverride, int loops, Walk walk)
+{
+    using clock = std::chrono::steady_clock;
+
+    std::uint64_t nodes = 0;
+    auto t0 = clock::now();
+    for (int l = 0; l < loops; ++l)
+        for (const BenchPos& p : SUITE) {
+            Board b = from_fen(p.fen);
+            nodes += walk(b, depthOverride > 0 ? depthOverride : p.depth);
+        }
+    auto t1 = clock::now();
+
+    std::chrono::duration<double> dt = t1 - t0;
+    const double secs = dt.count();
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Mode: " << std::setw(11) << std::left << mode << std::right << " | Nodes: " << nodes
+              << " | Time: " << secs << " s" << " | Throughput: " << (nodes / secs) / 1e6 << " Mnps\n";
+}
+
+int main(int argc, char** argv)
+{
+    int DEPTH = 0; // 0 = suite depths
+    int LOOPS = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto need = [&](const char* what) -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << what << "\n";
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+        if (a == "--depth")
+            DEPTH = std::stoi(need("--depth"));
+        else if (a == "--loops")
+            LOOPS = std::stoi(need("--loops"));
+        else if (a == "-h" || a == "--help") {
+            usage(argv[0]);
+            return 0;
+        } else {
+            std::cerr << "Unknown arg: " << a << "\n";
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::cerr << "Board: " << sizeof(Board) << " bytes, aligned to " << alignof(Board) << "\n";
+
+    // warm up tables and caches once, then time each mode
+    run("warmup", 3, 1, [](Board& b, int d) { return walk_unmake(b, d); });
+    run("make/unmake", DEPTH, LOOPS, [](Board& b, int d) { return walk_unmake(b, d); });
+    run("copy-make", DEPTH, LOOPS, [](Board& b, int d) { return walk_copy(b, d); });
+
+    return 0;
+}
@@ -0,0 +1,254 @@
+// tools/perft_bench.cc
+#include "engine/attack_fill.hh"
+#include "engine/board.hh"
+#include "engine/fen.hh"
+#include "engine/magic.hh"
+#include "engine/perft.hh"
+#include "engine/serialize.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace engine;
+
+static void usage(const char* argv0)
+{
+    std::cerr << "Usage:\n"
+                 "  "
+              << argv0
+              << " --epd FILE [--depth D] [--threads T] [--hash MB] [--json FILE]\n"
+                 "\n"
+                 "Notes:\n"
+                 "  EPD lines are 'FEN ;D1 n1 ;D2 n2 ...'; every listed depth up to D is run and checked.\n"
+                 "  --threads 0 uses every hardware thread (default 1). --hash 0 disables the perft cache.\n"
+                 "  --json writes a per-position summary to diff between builds.\n"
+                 "  Exits with status 2 if any count differs from the EPD.\n";
+}
+
+struct EpdEntry {
+    std::string fen;
+    std::vector<std::pair<int, std::uint64_t>> depths; // (depth, expected nodes)
+};
+
+static bool read_epd(const std::string& path, std::vector<EpdEntry>& out)
+{
+    std::ifstream in(path);
+    if (!in)
+        return false;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        auto hash = line.find('#');
+        if (hash != std::string::npos)
+            line = line.substr(0, hash);
+
+        std::stringstream ss(line);
+        std::string field;
+        if (!std::getline(ss, field, ';'))
+            continue;
+
+        EpdEntry e;
+        std::stringstream fs(field);
+        std::string tok;
+        int n = 0;
+        while (fs >> tok)
+            e.fen += (n++ ? " " : "") + tok;
+        if (n == 0)
+            continue;
+        if (n == 4) // EPD positions carry no move counters
+            e.fen += " 0 1";
+
+        while (std::getline(ss, field, ';')) {
+            std::stringstream ds(field);
+            std::string d;
+            std::uint64_t nodes = 0;
+            if (ds >> d >> nodes && d.size() > 1 && d[0] == 'D')
+                e.depths.emplace_back(std::stoi(d.substr(1)), nodes);
+        }
+        out.push_back(std::move(e));
+    }
+    return true;
+}
+
+struct Result {
+    const EpdEntry* entry;
+    int depth;
+    std::uint64_t expected;
+    std::uint64_t nodes;
+    double secs;
+};
+
+static std::string json_escape(const std::string& s)
+{
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+static void write_json(std::ostream& os, const std::vector<Result>& results, int threads, int hashMb)
+{
+    std::uint64_t nodes = 0;
+    double secs = 0.0;
+    int failures = 0;
+    for (const Result& r : results) {
+        nodes += r.nodes;
+        secs += r.secs;
+        failures += r.nodes != r.expected;
+    }
+
+    os << std::fixed << std::setprecision(6);
+    os << "{\n";
+    os << "  \"sliders\": \"" << slider_backend() << "\",\n";
+    os << "  \"serialize\": \"" << serialize_backend() << "\",\n";
+    os << "  \"fill\": \"" << fill_backend() << "\",\n";
+    os << "  \"threads\": " << threads << ",\n";
+    os << "  \"hash_mb\": " << hashMb << ",\n";
+    os << "  \"positions\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        os << "    {\"fen\": \"" << json_escape(r.entry->fen) << "\", \"depth\": " << r.depth
+           << ", \"nodes\": " << r.nodes << ", \"expected\": " << r.expected
+           << ", \"ok\": " << (r.nodes == r.expected ? "true" : "false") << ", \"seconds\": " << r.secs
+           << ", \"mnps\": " << (r.secs > 0 ? r.nodes / r.secs / 1e6 : 0.0) << "}"
+           << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "  ],\n";
+    os << "  \"total\": {\"nodes\": " << nodes << ", \"seconds\": " << secs
+       << ", \"mnps\": " << (secs > 0 ? nodes / secs / 1e6 : 0.0) << ", \"failures\": " << failures << "}\n";
+    os << "}\n";
+}
+
+int main(int argc, char** argv)
+{
+    std::string EPD;
+    std::string JSON;
+    int DEPTH = 0; // 0 = every depth in the file
+    int THREADS = 1;
+    int HASH_MB = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto need = [&](const char* what) -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << what << "\n";
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+        if (a == "--epd")
+            EPD = need("--epd");
+        else if (a == "--depth")
+            DEPTH = std::stoi(need("--depth"));
+        else if (a == "--threads")
+            THREADS = std::stoi(need("--threads"));
+        else if (a == "--hash")
+            HASH_MB = std::stoi(need("--hash"));
+        else if (a == "--json")
+            JSON = need("--json");
+        else if (a == "-h" || a == "--help") {
+            usage(argv[0]);
+            return 0;
+        } else {
+            std::cerr << "Unknown arg: " << a << "\n";
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (EPD.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<EpdEntry> suite;
+    if (!read_epd(EPD, suite)) {
+        std::cerr << "Failed to open " << EPD << "\n";
+        return 1;
+    }
+    if (THREADS <= 0)
+        THREADS = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    std::unique_ptr<PerftTable> tt;
+    if (HASH_MB > 0)
+        tt = std::make_unique<PerftTable>(static_cast<std::size_t>(HASH_MB));
+
+    std::cerr << "Backends: sliders=" << slider_backend() << " serialize=" << serialize_backend()
+              << " fill=" << fill_backend() << " | threads=" << THREADS << " hash=" << HASH_MB << " MB\n";
+
+    using clock = std::chrono::steady_clock;
+    std::vector<Result> results;
+    int failures = 0;
+
+    std::cout << std::fixed << std::setprecision(2);
+    for (const EpdEntry& e : suite) {
+        Board root;
+        try {
+            root = from_fen(e.fen);
+        } catch (const std::exception& ex) {
+            std::cerr << ex.what() << "\n";
+            return 1;
+        }
+
+        for (const auto& [depth, expected] : e.depths) {
+            if (DEPTH > 0 && depth > DEPTH)
+                continue;
+
+            // each depth starts cold so timings do not depend on suite order
+            if (tt)
+                tt->clear();
+
+            auto t0 = clock::now();
+            const std::uint64_t nodes = perft(root, depth, THREADS, tt.get());
+            std::chrono::duration<double> dt = clock::now() - t0;
+
+            results.push_back({&e, depth, expected, nodes, dt.count()});
+            const bool ok = nodes == expected;
+            failures += !ok;
+
+            std::cout << (ok ? "ok  " : "FAIL") << " | D" << depth << " | Nodes: " << std::setw(11) << nodes
+                      << " | Time: " << std::setw(7) << dt.count() << " s"
+                      << " | Throughput: " << std::setw(8) << (dt.count() > 0 ? nodes / dt.count() / 1e6 : 0.0)
+                      << " Mnps | " << e.fen;
+            if (!ok)
+                std::cout << " (expected " << expected << ")";
+            std::cout << "\n";
+        }
+    }
+
+    std::uint64_t nodes = 0;
+    double secs = 0.0;
+    for (const Result& r : results) {
+        nodes += r.nodes;
+        secs += r.secs;
+    }
+    std::cout << "Total | Nodes: " << nodes << " | Time: " << secs << " s"
+              << " | Throughput: " << (secs > 0 ? nodes / secs / 1e6 : 0.0) << " Mnps | Failures: " << failures
+              << "\n";
+
+    if (!JSON.empty()) {
+        std::ofstream out(JSON);
+        if (!out) {
+            std::cerr << "Failed to write " << JSON << "\n";
+            return 1;
+        }
+        write_json(out, results, THREADS, HASH_MB);
+    }
+
+    return failures ? 2 : 0;
+}